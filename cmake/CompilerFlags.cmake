@@ -9,7 +9,13 @@ function(set_target_compiler_flags TARGET)
     if (CMAKE_CXX_COMPILER_ID STREQUAL "GNU" OR
             CMAKE_CXX_COMPILER_ID STREQUAL "Clang")
         set(DEBUG_FLAGS -Og -g)
-        set(RELEASE_FLAGS -O3 -march=native)
+        # Hot kernels are built for several instruction sets and dispatched
+        # at runtime, so the default build stays portable across CPUs.
+        if (PRIMAL_NATIVE)
+            set(RELEASE_FLAGS -O3 -march=native)
+        else ()
+            set(RELEASE_FLAGS -O3)
+        endif ()
     else ()
         message(WARNING
                 "Skipping flags for unknown compiler: ${CMAKE_CXX_COMPILER_ID}")
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file adjacent.hpp
+ * @brief Defines function templates that print the primes just above or just
+ * below a given number.
+ */
+
+#ifndef PRIMAL_ADJACENT_HPP
+#define PRIMAL_ADJACENT_HPP
+
+#include <concepts>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "primal/job.hpp"
+#include "primal/utils/io/open-output.hpp"
+#include "primal/utils/math/prime-search.hpp"
+#include "primal/utils/string/append-integer.hpp"
+#include "primal/utils/uint128.hpp"
+
+namespace primal::functions {
+
+/**
+ * Write one prime per line.
+ * @tparam T Unsigned integer type
+ * @param primes Primes to write
+ * @param job Output settings
+ */
+template <typename T>
+requires utils::UnsignedInteger<T>
+void printPrimes(const std::vector<T>& primes, const Job& job) {
+    using utils::string::appendInteger;
+
+    std::string text;
+    for (T prime : primes) {
+        appendInteger(text, prime);
+        text += '\n';
+    }
+    utils::io::openOutput(job.output)->write(text);
+}
+
+/**
+ * Prints the primes immediately above a given number in ascending order.
+ * @tparam T Unsigned integer type
+ * @param number Number to search above
+ * @param count Number of primes to print
+ * @param job Output settings
+ */
+template <typename T>
+requires utils::UnsignedInteger<T>
+void next(T number, uint64_t count, const Job& job = {}) {
+    std::vector<T> primes = utils::math::nextPrimes(number, count);
+    if (primes.size() < count) {
+        std::string text = "Not enough primes above ";
+        utils::string::appendInteger(text, number);
+        throw std::runtime_error(text + ".");
+    }
+    printPrimes(primes, job);
+}
+
+/**
+ * Prints the primes immediately below a given number in descending order.
+ * @tparam T Unsigned integer type
+ * @param number Number to search below
+ * @param count Number of primes to print
+ * @param job Output settings
+ */
+template <typename T>
+requires utils::UnsignedInteger<T>
+void prev(T number, uint64_t count, const Job& job = {}) {
+    std::vector<T> primes = utils::math::previousPrimes(number, count);
+    if (primes.size() < count) {
+        std::string text = "Not enough primes below ";
+        utils::string::appendInteger(text, number);
+        throw std::runtime_error(text + ".");
+    }
+    printPrimes(primes, job);
+}
+
+} // namespace primal::functions
+
+#endif // PRIMAL_ADJACENT_HPP
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file build-index.hpp
+ * @brief Defines a function template that writes a pi index up to a given
+ * ceiling.
+ */
+
+#ifndef PRIMAL_BUILD_INDEX_HPP
+#define PRIMAL_BUILD_INDEX_HPP
+
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "primal/job.hpp"
+#include "primal/utils/io/open-output.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/memory-budget.hpp"
+#include "primal/utils/ordered-pipeline.hpp"
+#include "primal/utils/pi-index.hpp"
+#include "primal/utils/progress.hpp"
+
+namespace primal::functions {
+
+/**
+ * Write a pi index with a checkpoint every piIndexStep numbers up to a given
+ * ceiling.
+ * @details Worker threads sieve and count one segment each. The calling thread
+ * adds the counts up in order and records the total at every checkpoint.
+ * @tparam T Unsigned integer type
+ * @param ceiling Largest number the index should cover
+ * @param job Output, progress and memory settings
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+void buildIndex(T ceiling, const Job& job = {}) {
+    using utils::Chunk;
+    using utils::MemoryBudget;
+    using utils::OrderedPipeline;
+    using utils::PiIndex;
+    using utils::piIndexStep;
+    using utils::Progress;
+    using utils::io::openOutput;
+    using utils::math::basePrimeCount;
+    using utils::math::basePrimes;
+    using utils::math::Segment;
+    using utils::math::segmentSpan;
+
+    // Only the numbers below the last checkpoint need to be sieved.
+    const uint64_t checkpoints = ceiling / piIndexStep + 1;
+    const uint64_t perStep = piIndexStep / segmentSpan;
+    const uint64_t segments = (checkpoints - 1) * perStep;
+    const T limit = static_cast<T>((checkpoints - 1) * piIndexStep);
+
+    // Each worker only holds a bitmap.
+    MemoryBudget budget(job.maxMemory);
+    budget.reserve(checkpoints * sizeof(uint64_t), "the checkpoints");
+    budget.reserve(basePrimeCount(limit) * sizeof(uint32_t),
+                   "the base primes");
+    const auto [workers, slots] = budget.pipeline(segmentSpan / 16, 0);
+
+    std::vector<uint64_t> counts{0};
+    counts.reserve(checkpoints);
+    Progress progress(limit, 0, job.progress);
+    const std::vector<uint32_t> primes =
+        limit ? basePrimes(static_cast<T>(limit - 1)) : std::vector<uint32_t>{};
+
+    // Count on the workers, add the counts up in order on this thread.
+    uint64_t total = 0;
+    OrderedPipeline pipeline(segments, workers, slots);
+    pipeline.run(
+        [&](std::size_t task, Chunk& chunk) {
+            thread_local Segment<T> segment;
+            T low = static_cast<T>(task * segmentSpan);
+            segment.sieve(low, static_cast<T>(low + segmentSpan - 1), primes);
+            chunk.count = segment.count();
+        },
+        [&](std::size_t task, const Chunk& chunk) {
+            total += chunk.count;
+            if ((task + 1) % perStep == 0) counts.push_back(total);
+            progress.update((task + 1) * segmentSpan);
+        });
+
+    auto output = openOutput(job.output, 0, budget.outputBuffer());
+    PiIndex::write(*output, piIndexStep, ceiling, counts);
+}
+
+} // namespace primal::functions
+
+#endif // PRIMAL_BUILD_INDEX_HPP
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file count.hpp
+ * @brief Defines a function template that prints the number of primes up to a
+ * given ceiling.
+ */
+
+#ifndef PRIMAL_COUNT_HPP
+#define PRIMAL_COUNT_HPP
+
+#include <concepts>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "primal/job.hpp"
+#include "primal/utils/checkpoint.hpp"
+#include "primal/utils/io/open-output.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/memory-budget.hpp"
+#include "primal/utils/ordered-pipeline.hpp"
+#include "primal/utils/pi-index.hpp"
+#include "primal/utils/progress.hpp"
+#include "primal/utils/shard.hpp"
+#include "primal/utils/string/append-integer.hpp"
+
+namespace primal::functions {
+
+/**
+ * Write the number of primes up to a ceiling.
+ * @tparam T Unsigned integer type
+ * @param ceiling Largest number counted
+ * @param total Number of primes up to the ceiling
+ * @param output Output to write to
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+void printCount(T ceiling, uint64_t total, utils::io::OutputSink& output) {
+    using utils::string::appendInteger;
+
+    std::string text = "pi(";
+    appendInteger(text, ceiling);
+    text += ") = ";
+    appendInteger(text, total);
+    text += '\n';
+    output.write(text);
+}
+
+/**
+ * Print the number of primes up to a given ceiling.
+ * @details Worker threads sieve and count one segment each. The calling thread
+ * adds the counts up in segment order so that checkpoints can be recorded at
+ * segment boundaries. With a pi index, only the numbers between the ceiling
+ * and the nearest checkpoint are sieved. A shard only counts its own segments
+ * and writes a partial result instead of the total.
+ * @tparam T Unsigned integer type
+ * @param ceiling Largest number to check
+ * @param job Output, checkpoint, progress, pi index, memory and shard settings
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+void count(T ceiling, const Job& job = {}) {
+    using utils::Checkpointer;
+    using utils::Chunk;
+    using utils::MemoryBudget;
+    using utils::OrderedPipeline;
+    using utils::Partial;
+    using utils::PiIndex;
+    using utils::Progress;
+    using utils::shardSegments;
+    using utils::io::openOutput;
+    using utils::math::basePrimeCount;
+    using utils::math::basePrimes;
+    using utils::math::countPrimes;
+    using utils::math::Segment;
+    using utils::math::segmentBounds;
+    using utils::math::segmentCount;
+    using utils::math::segmentSpan;
+
+    // Segments to count and the prime count to continue from.
+    const uint64_t segments = segmentCount(ceiling);
+    uint64_t first = job.resume.segment;
+    uint64_t end = segments;
+    if (job.shard.count) {
+        std::tie(first, end) = shardSegments(ceiling, job.shard, false);
+    } else if (first >= segments) {
+        return;
+    }
+    uint64_t total = job.resume.count;
+
+    // Start from the nearest checkpoint of a pi index if there is one.
+    MemoryBudget budget(job.maxMemory);
+    if (!job.piIndex.empty() && !job.shard.count) {
+        PiIndex index(job.piIndex);
+        uint64_t k = index.floor(ceiling);
+        uint64_t below = k * index.step();
+
+        // Count back from the next checkpoint when it is closer.
+        if (k + 1 < index.size() &&
+            below + index.step() - 1 - ceiling < ceiling - below) {
+            T next = static_cast<T>(below + index.step() - 1);
+            budget.reserve(basePrimeCount(next) * sizeof(uint32_t),
+                           "the base primes");
+            total = index.count(k + 1) -
+                    countPrimes(static_cast<T>(ceiling + 1), next,
+                                basePrimes(next));
+            printCount(ceiling, total, *openOutput(job.output));
+            return;
+        }
+
+        if (below / segmentSpan > first) {
+            first = below / segmentSpan;
+            total = index.count(k);
+        }
+    }
+
+    // Each worker only holds a bitmap.
+    budget.reserve(basePrimeCount(ceiling) * sizeof(uint32_t),
+                   "the base primes");
+    auto output =
+        openOutput(job.output, job.resume.offset, budget.outputBuffer());
+    const auto [workers, slots] = budget.pipeline(segmentSpan / 16, 0);
+
+    Checkpointer checkpointer(job.state,
+                              {"count", ceiling, job.output, first, total, 0});
+    Progress progress(end == segments ? ceiling : end * segmentSpan,
+                      first * segmentSpan, job.progress);
+
+    // Calculate the primes needed to sieve every segment.
+    const std::vector<uint32_t> primes = basePrimes(ceiling);
+
+    // Count on the workers, add the counts up in order on this thread.
+    OrderedPipeline pipeline(end - first, workers, slots);
+    pipeline.run(
+        [&](std::size_t task, Chunk& chunk) {
+            thread_local Segment<T> segment;
+            T low, high;
+            segmentBounds(first + task, ceiling, low, high);
+            segment.sieve(low, high, primes);
+            chunk.count = segment.count();
+        },
+        [&](std::size_t task, const Chunk& chunk) {
+            total += chunk.count;
+            uint64_t done = first + task + 1;
+            checkpointer.completed(done, total, *output, false);
+            progress.update(done == segments ? ceiling : done * segmentSpan);
+        });
+
+    if (job.shard.count) {
+        Partial::of("count", ceiling, job.shard, first, end, total)
+            .write(*output);
+        return;
+    }
+
+    // Print the total once every segment has been counted.
+    printCount(ceiling, total, *output);
+    checkpointer.completed(segments, total, *output, true);
+}
+
+} // namespace primal::functions
+
+#endif // PRIMAL_COUNT_HPP
@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file goldbach.hpp
+ * @brief Defines a function template that counts the Goldbach partitions of
+ * every even number in a range and finds their smallest witnesses.
+ */
+
+#ifndef PRIMAL_GOLDBACH_HPP
+#define PRIMAL_GOLDBACH_HPP
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "primal/job.hpp"
+#include "primal/utils/io/open-output.hpp"
+#include "primal/utils/math/kernels.hpp"
+#include "primal/utils/math/primality-test.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/memory-budget.hpp"
+#include "primal/utils/ordered-pipeline.hpp"
+#include "primal/utils/progress.hpp"
+#include "primal/utils/string/append-integer.hpp"
+
+namespace primal::functions {
+
+/**
+ * Amount of even numbers handled by one task when counting partitions.
+ */
+inline constexpr uint64_t goldbachBlock = 256;
+
+/**
+ * Amount of bitmap words compared for every number of a block before moving
+ * on to the next words.
+ * @details The 32 KiB of the bitmap and the matching words of its reversed
+ * copy stay in the L1 and L2 caches while the whole block passes over them.
+ */
+inline constexpr std::size_t goldbachTile = 4096;
+
+/**
+ * Largest prime tried as a witness before falling back to primality tests.
+ * @details The smallest witness of every even number below 4 * 10^18 is below
+ * 10^4, so the fallback is never needed in practice.
+ */
+inline constexpr uint64_t witnessSpan = uint64_t{1} << 16;
+
+/**
+ * Reverse the order of the bits of a word.
+ * @param word Word to reverse
+ * @return Word with bit i moved to bit 63 - i
+ */
+inline uint64_t reverseBits(uint64_t word) {
+    // Swap neighbouring bits, then pairs and nibbles, and finally bytes.
+    constexpr uint64_t masks[] = {0x5555555555555555, 0x3333333333333333,
+                                  0x0F0F0F0F0F0F0F0F};
+    for (unsigned i = 0; i < 3; i++) {
+        unsigned width = 1U << i;
+        word = ((word >> width) & masks[i]) | ((word & masks[i]) << width);
+    }
+    return std::byteswap(word);
+}
+
+/**
+ * Find the smallest prime p with n - p also prime, testing both with the
+ * Miller-Rabin test.
+ * @tparam T Unsigned integer type
+ * @param number Even number to split
+ * @param from Odd number to start trying from
+ * @return Smallest witness from the starting point, or 0 if there is none
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+T testedWitness(T number, T from) {
+    using utils::math::millerRabinTest;
+    using utils::math::Primality;
+
+    for (T p = from; p <= number / 2; p += 2) {
+        if (millerRabinTest(p) == Primality::PRIME &&
+            millerRabinTest(static_cast<T>(number - p)) == Primality::PRIME) {
+            return p;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Print the smallest Goldbach witness of every even number in a range.
+ * @details Worker threads sieve one window each, reaching witnessSpan below
+ * the numbers they cover, and scan the primes up to witnessSpan in ascending
+ * order until n - p is marked as prime in the window.
+ * @tparam T Unsigned integer type
+ * @param low Smallest even number (at least 4)
+ * @param high Largest number
+ * @param job Output, progress and memory settings
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+void goldbachWitnesses(T low, T high, const Job& job) {
+    using utils::Chunk;
+    using utils::MemoryBudget;
+    using utils::OrderedPipeline;
+    using utils::Progress;
+    using utils::io::openOutput;
+    using utils::math::basePrimeCount;
+    using utils::math::basePrimes;
+    using utils::math::Segment;
+    using utils::math::segmentSpan;
+    using utils::string::appendInteger;
+
+    // Each worker holds the bitmap of a window; each buffer holds its lines.
+    MemoryBudget budget(job.maxMemory);
+    budget.reserve(basePrimeCount(high) * sizeof(uint32_t),
+                   "the base primes");
+    auto output = openOutput(job.output, 0, budget.outputBuffer());
+    const auto [workers, slots] = budget.pipeline(
+        (segmentSpan + witnessSpan) / 16, segmentSpan / 2 * 24);
+
+    Progress progress(high, low, job.progress);
+    const uint64_t tasks = (high - low) / segmentSpan + 1;
+    const std::vector<uint32_t> primes = basePrimes(high);
+    const std::vector<uint32_t> candidates =
+        basePrimes(witnessSpan * witnessSpan);
+
+    OrderedPipeline pipeline(tasks, workers, slots);
+    pipeline.run(
+        [&](std::size_t task, Chunk& chunk) {
+            thread_local Segment<T> segment;
+            T first = static_cast<T>(low + task * segmentSpan);
+            T last = high - first < segmentSpan
+                         ? high
+                         : static_cast<T>(first + segmentSpan - 1);
+            T start = first > witnessSpan ? first - witnessSpan : 0;
+            segment.sieve(static_cast<T>(start & ~T{1}), last, primes);
+
+            for (T n = first;; n += 2) {
+                T witness = n == 4 ? 2 : 0;
+                for (uint32_t p : candidates) {
+                    if (witness || p > n / 2) break;
+                    if (segment.contains(static_cast<T>(n - p))) witness = p;
+                }
+                if (!witness && n / 2 > witnessSpan) {
+                    witness = testedWitness(n, T{witnessSpan + 1});
+                }
+                appendInteger(chunk.text, n);
+                chunk.text += ' ';
+                appendInteger(chunk.text, witness);
+                chunk.text += '\n';
+                if (last - n < 2) break;
+            }
+        },
+        [&](std::size_t task, const Chunk& chunk) {
+            output->write(chunk.text);
+            progress.update(task + 1 == tasks
+                                ? high
+                                : low + (task + 1) * segmentSpan);
+        });
+}
+
+/**
+ * Print the number of Goldbach partitions and the smallest witness of every
+ * even number in a range.
+ * @details Bit i of the prime bitmap marks the odd number 2i + 1, so the
+ * partitions of n = 2m + 2 are the bits i <= m / 2 set in both the bitmap and
+ * the bitmap read backwards from bit m. A reversed copy of the bitmap turns
+ * that into a word-level AND and popcount, which the kernels vectorize. Worker
+ * threads count one block of even numbers each, passing the whole block over
+ * one cache-sized tile of the bitmap at a time.
+ * @tparam T Unsigned integer type
+ * @param low Smallest even number (at least 4)
+ * @param high Largest number
+ * @param job Output, progress and memory settings
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+void goldbachPartitions(T low, T high, const Job& job) {
+    using utils::Chunk;
+    using utils::MemoryBudget;
+    using utils::OrderedPipeline;
+    using utils::Progress;
+    using utils::io::openOutput;
+    using utils::math::basePrimeCount;
+    using utils::math::basePrimes;
+    using utils::math::Segment;
+    using utils::math::segmentCount;
+    using utils::math::segmentSpan;
+    using utils::math::kernels::andPopcount;
+    using utils::string::appendInteger;
+
+    // Both bitmaps cover every odd number up to the ceiling, with one word of
+    // room after the reversed one.
+    const std::size_t words = static_cast<std::size_t>(high / 128 + 1);
+    const std::size_t bits = words * 64;
+    MemoryBudget budget(job.maxMemory);
+    budget.reserve(basePrimeCount(high) * sizeof(uint32_t),
+                   "the base primes");
+    budget.reserve((2 * words + 1) * sizeof(uint64_t), "the prime bitmaps");
+    auto output = openOutput(job.output, 0, budget.outputBuffer());
+    const auto [workers, slots] =
+        budget.pipeline(segmentSpan / 16, goldbachBlock * 48);
+
+    // Sieve the bitmap on the workers, one segment each.
+    std::vector<uint64_t> bitmap(words);
+    {
+        const std::vector<uint32_t> primes = basePrimes(high);
+        OrderedPipeline pipeline(segmentCount(high), workers, slots);
+        pipeline.run(
+            [&](std::size_t task, Chunk&) {
+                thread_local Segment<T> segment;
+                T first = static_cast<T>(task * segmentSpan);
+                T last = high - first < segmentSpan
+                             ? high
+                             : static_cast<T>(first + segmentSpan - 1);
+                segment.sieve(first, last, primes);
+                std::ranges::copy(segment.bitmap(),
+                                  bitmap.begin() + task * (segmentSpan / 128));
+            },
+            [](std::size_t, const Chunk&) {});
+    }
+
+    // Bit k of the reversed copy is bit bits - 1 - k of the bitmap.
+    std::vector<uint64_t> reversed(words + 1);
+    for (std::size_t i = 0; i < words; i++) {
+        reversed[i] = reverseBits(bitmap[words - 1 - i]);
+    }
+
+    Progress progress(high, low, job.progress);
+    const uint64_t tasks = (high - low) / (2 * goldbachBlock) + 1;
+
+    OrderedPipeline pipeline(tasks, workers, slots);
+    pipeline.run(
+        [&](std::size_t task, Chunk& chunk) {
+            T first = static_cast<T>(low + task * 2 * goldbachBlock);
+            std::size_t size = static_cast<std::size_t>(
+                std::min<uint64_t>((high - first) / 2 + 1, goldbachBlock));
+
+            // Number n = first + 2j pairs bit i with reversed bit offset + i,
+            // comparing the bits up to half of m in whole words and a tail.
+            uint64_t counts[goldbachBlock] = {};
+            auto half = [&](std::size_t j) {
+                return static_cast<std::size_t>((first / 2 + j - 1) / 2);
+            };
+            auto offset = [&](std::size_t j) {
+                return bits - static_cast<std::size_t>(first / 2 + j);
+            };
+            for (std::size_t tile = 0; tile <= half(size - 1) / 64;
+                 tile += goldbachTile) {
+                for (std::size_t j = 0; j < size; j++) {
+                    std::size_t full = (half(j) + 1) / 64;
+                    if (full <= tile) continue;
+                    std::size_t shift = offset(j) + tile * 64;
+                    counts[j] += andPopcount(
+                        bitmap.data() + tile, reversed.data() + shift / 64,
+                        static_cast<unsigned>(shift % 64),
+                        std::min(full, tile + goldbachTile) - tile);
+                }
+            }
+
+            for (std::size_t j = 0; j < size; j++) {
+                T n = static_cast<T>(first + 2 * j);
+                std::size_t m = static_cast<std::size_t>(n / 2 - 1);
+                std::size_t full = (half(j) + 1) / 64;
+                std::size_t tail = (half(j) + 1) % 64;
+                if (tail) {
+                    std::size_t shift = offset(j) + full * 64;
+                    uint64_t word = bitmap[full] & ((uint64_t{1} << tail) - 1);
+                    counts[j] += andPopcount(&word,
+                                             reversed.data() + shift / 64,
+                                             static_cast<unsigned>(shift % 64),
+                                             1);
+                }
+
+                // Scan the bitmap for the smallest odd prime that pairs up.
+                T witness = n == 4 ? 2 : 0;
+                if (n == 4) counts[j]++;
+                for (std::size_t i = 1; !witness && i <= m / 2; i++) {
+                    if ((bitmap[i / 64] >> (i % 64)) & 1 &&
+                        (bitmap[(m - i) / 64] >> ((m - i) % 64)) & 1) {
+                        witness = static_cast<T>(2 * i + 1);
+                    }
+                }
+
+                appendInteger(chunk.text, n);
+                chunk.text += ' ';
+                appendInteger(chunk.text, counts[j]);
+                chunk.text += ' ';
+                appendInteger(chunk.text, witness);
+                chunk.text += '\n';
+            }
+        },
+        [&](std::size_t task, const Chunk& chunk) {
+            output->write(chunk.text);
+            progress.update(task + 1 == tasks
+                                ? high
+                                : low + (task + 1) * 2 * goldbachBlock);
+        });
+}
+
+/**
+ * Print the Goldbach partitions of every even number in a range.
+ * @details Either counts the partitions of every number and finds its
+ * smallest witness, which needs a bitmap of every odd number up to the end of
+ * the range, or only finds the witnesses, which needs one window of the sieve
+ * per worker.
+ * @tparam T Unsigned integer type
+ * @param low Smallest number of the range
+ * @param high Largest number of the range
+ * @param witnessesOnly Skip counting the partitions
+ * @param job Output, progress and memory settings
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+void goldbach(T low, T high, bool witnessesOnly, const Job& job = {}) {
+    // Start from the first even number with a partition.
+    low = std::max(low, T{4});
+    if (low % 2) low++;
+    if (low < 4 || low > high) {
+        throw std::runtime_error("Invalid Goldbach range.");
+    }
+
+    if (witnessesOnly) goldbachWitnesses(low, high, job);
+    else goldbachPartitions(low, high, job);
+}
+
+} // namespace primal::functions
+
+#endif // PRIMAL_GOLDBACH_HPP
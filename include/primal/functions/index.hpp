@@ -26,62 +26,53 @@
  * index.
  */
 
-#include <cmath>
 #include <concepts>
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
 #include <type_traits>
-#include <vector>
 
-#include "primal/utils/math/sieve.hpp"
+#include "primal/job.hpp"
+#include "primal/utils/math/prime-count-bound.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/memory-budget.hpp"
 
 namespace primal::functions {
 
 /**
  * Prints the prime with a particular index.
+ * @details Sieves one segment at a time from zero, so memory stays bounded by
+ * the base primes needed for an upper bound of the prime.
  * @tparam T Unsigned integer type
  * @param number Prime index
+ * @param job Memory settings
  */
 template <typename T>
 requires std::is_unsigned_v<T>
-void index(T number) {
-    using std::log, std::max;
-    using utils::math::sieve;
-
-    // Prepare a vector to store the primes found.
-    std::vector<T> primes;
-
-    // Sieve ceiling used for calculations.
-    T ceiling;
-
-    // Prime number theorem estimate of the Nth prime.
-    T ceilingEstimate = number * log(number) + number * log(log(number));
-
-    // Minimum sieve ceiling (in case the estimate is below the Nth prime).
-    T ceilingMin = 15;
-
-    // Offset the number by -1 to compensate for zero-based indexing.
-    number--;
-
-    // Sieve until the Nth prime is found.
-    while (true) {
-        // (Re)calculate the sieve ceiling.
-        ceiling = max(ceilingEstimate, ceilingMin);
-
-        // Calculate the primes up to the ceiling.
-        sieve(ceiling, primes);
-
-        // Display the Nth prime if it was found.
-        if (number < primes.size()) {
-            std::cout << "Prime #" << number << " = " << primes[number] << "\n";
-            break;
-        }
+void index(T number, const Job& job = {}) {
+    using utils::MemoryBudget;
+    using utils::math::basePrimeCount;
+    using utils::math::basePrimes;
+    using utils::math::maxPrimeIndex;
+    using utils::math::nthPrime;
+    using utils::math::nthPrimeUpperBound;
+    using utils::math::segmentSpan;
+
+    if (number == 0) throw std::runtime_error("Invalid index.");
+    if (number > maxPrimeIndex<T>()) {
+        throw std::runtime_error("Index out of range.");
+    }
 
-        // Increase the sieve ceiling by 10% if the Nth prime was not found.
-        ceilingMin = static_cast<T>(ceiling * 1.1);
+    // Reserve the base primes and the segment before allocating either.
+    const T ceiling = nthPrimeUpperBound<T>(number);
+    MemoryBudget budget(job.maxMemory);
+    budget.reserve(basePrimeCount(ceiling) * sizeof(uint32_t),
+                   "the base primes");
+    budget.reserve(segmentSpan / 16, "the segment");
 
-        // Clear the primes vector before sieving again.
-        primes.clear();
-    }
+    T prime = nthPrime(T{0}, number, basePrimes(ceiling));
+    if (!prime) throw std::runtime_error("Index out of range.");
+    std::cout << "Prime #" << number << " = " << prime << "\n";
 }
 
 } // namespace primal::functions
@@ -27,43 +27,141 @@
 #define PRIMAL_LIST_HPP
 
 #include <concepts>
-#include <cstdio>
-#include <sstream>
+#include <cstdint>
+#include <filesystem>
 #include <string>
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
-#include "primal/utils/math/sieve.hpp"
-#include "primal/utils/string/format-specifier.hpp"
+#include "primal/job.hpp"
+#include "primal/utils/checkpoint.hpp"
+#include "primal/utils/io/open-output.hpp"
+#include "primal/utils/math/kernels.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/memory-budget.hpp"
+#include "primal/utils/ordered-pipeline.hpp"
+#include "primal/utils/progress.hpp"
+#include "primal/utils/shard.hpp"
+#include "primal/utils/trace.hpp"
 
 namespace primal::functions {
 
 /**
  * Print every prime up to a given ceiling.
+ * @details Worker threads sieve one segment each and render its output lines
+ * into a private buffer, using the prime counts of earlier segments to number
+ * them. The calling thread writes the buffers in segment order and records
+ * checkpoints at segment boundaries. A shard numbers the primes of its own
+ * segments from 1, writes them next to its output file (with a ".primes"
+ * suffix) and writes a partial result to the output file itself.
  * @tparam T Unsigned integer type
  * @param ceiling Largest number to check
+ * @param job Output, checkpoint, progress, memory and shard settings
  */
 template <typename T>
 requires std::is_unsigned_v<T>
-void list(T ceiling) {
-    using utils::math::sieve;
-    using utils::string::formatSpecifier;
-
-    // Calculate the primes up to the ceiling.
-    std::vector<T> primes;
-    sieve(ceiling, primes);
-
-    // Build the printf string for the output.
-    std::string format = formatSpecifier<T>();
-    std::stringstream outputFormatStream;
-    outputFormatStream << "Prime #" << format << " = " << format << "\n";
-    std::string outputFormat = outputFormatStream.str();
-    const char* output = outputFormat.c_str();
-
-    // Print the calculated primes and their indices.
-    // Use printf inside the loop to increase performance.
-    for (T i = 0; i < primes.size(); i++) {
-        printf(output, (i + 1), primes[i]);
+void list(T ceiling, const Job& job = {}) {
+    using utils::Checkpointer;
+    using utils::Chunk;
+    using utils::MemoryBudget;
+    using utils::OrderedPipeline;
+    using utils::Partial;
+    using utils::PrefixSum;
+    using utils::Progress;
+    using utils::shardSegments;
+    using utils::io::openOutput;
+    using utils::math::basePrimeCount;
+    using utils::math::basePrimes;
+    using utils::math::Segment;
+    using utils::math::segmentBounds;
+    using utils::math::segmentCount;
+    using utils::math::segmentPrimeCount;
+    using utils::math::segmentSpan;
+    using utils::math::kernels::formatPrimeLines;
+    using utils::math::kernels::maxPrimeLine;
+
+    // Return early unless the ceiling is above the first prime number (2).
+    if (ceiling < 2 && !job.shard.count) return;
+
+    // Segments to list and the prime count to continue from.
+    const uint64_t segments = segmentCount(ceiling);
+    uint64_t first = job.resume.segment;
+    uint64_t end = segments;
+    if (job.shard.count) {
+        std::tie(first, end) = shardSegments(ceiling, job.shard, true);
+    } else if (first >= segments) {
+        return;
+    }
+    const uint64_t found = job.resume.count;
+    const std::string path =
+        job.shard.count ? job.output + ".primes" : job.output;
+
+    // Each worker holds a bitmap, its set bits and its primes; each buffer
+    // holds the lines of one segment.
+    MemoryBudget budget(job.maxMemory);
+    budget.reserve(basePrimeCount(ceiling) * sizeof(uint32_t),
+                   "the base primes");
+    auto output = openOutput(path, job.resume.offset, budget.outputBuffer());
+    const auto [workers, slots] = budget.pipeline(
+        segmentSpan / 16 + segmentSpan / 2 * sizeof(uint32_t) +
+            segmentPrimeCount * sizeof(uint64_t),
+        segmentPrimeCount * maxPrimeLine);
+
+    Checkpointer checkpointer(job.state,
+                              {"list", ceiling, job.output, first, found, 0});
+    Progress progress(end == segments ? ceiling : end * segmentSpan,
+                      first * segmentSpan, job.progress);
+
+    // Calculate the primes needed to sieve every segment.
+    const std::vector<uint32_t> primes = basePrimes(ceiling);
+
+    // Number of primes in every segment before a given one.
+    PrefixSum counts;
+
+    // Sieve and format on the workers, write in order on this thread.
+    uint64_t total = found;
+    OrderedPipeline pipeline(end - first, workers, slots);
+    pipeline.run(
+        [&](std::size_t task, Chunk& chunk) {
+            thread_local Segment<T> segment;
+            T low, high;
+            segmentBounds(first + task, ceiling, low, high);
+            segment.sieve(low, high, primes);
+            chunk.count = segment.count();
+            counts.publish(task, chunk.count);
+
+            // Print the primes and their indices.
+            thread_local std::vector<uint64_t> values;
+            values.clear();
+            {
+                utils::trace::Span span("extract", "primes", chunk.count);
+                segment.forEachPrime(
+                    [&](T prime) { values.push_back(prime); });
+            }
+            uint64_t index = found + counts.before(task);
+            utils::trace::Span span("format", "primes", chunk.count);
+            chunk.text.resize_and_overwrite(
+                values.size() * maxPrimeLine, [&](char* out, std::size_t) {
+                    return formatPrimeLines(out, index, values.data(),
+                                            values.size());
+                });
+        },
+        [&](std::size_t task, const Chunk& chunk) {
+            output->write(chunk.text);
+            total += chunk.count;
+            uint64_t done = first + task + 1;
+            checkpointer.completed(done, total, *output, done == segments);
+            progress.update(done == segments ? ceiling : done * segmentSpan);
+        });
+
+    if (job.shard.count) {
+        Partial partial =
+            Partial::of("list", ceiling, job.shard, first, end, total);
+        partial.data = std::filesystem::path(path).filename().string();
+        partial.bytes = output->offset();
+        output.reset();
+        partial.write(*openOutput(job.output));
     }
 }
 
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file merge.hpp
+ * @brief Defines a function that combines the partial results of every shard
+ * of a job into the result of the whole job.
+ */
+
+#ifndef PRIMAL_MERGE_HPP
+#define PRIMAL_MERGE_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "primal/functions/count.hpp"
+#include "primal/job.hpp"
+#include "primal/utils/io/open-output.hpp"
+#include "primal/utils/math/kernels.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/memory-budget.hpp"
+#include "primal/utils/shard.hpp"
+
+namespace primal::functions {
+
+/**
+ * Amount of bytes of a shard's lines read at once while merging.
+ */
+inline constexpr std::size_t mergeBlock = std::size_t{1} << 20;
+
+/**
+ * Copy the lines of a listing shard to an output, adding the number of primes
+ * found by earlier shards to every index.
+ * @param partial Partial result of the shard
+ * @param found Number of primes found by earlier shards
+ * @param output Output to write to
+ */
+inline void renumber(const utils::Partial& partial, uint64_t found,
+                     utils::io::OutputSink& output) {
+    using utils::math::kernels::formatPrimeLines;
+    using utils::math::kernels::maxPrimeLine;
+
+    std::error_code error;
+    auto size = std::filesystem::file_size(partial.data, error);
+    if (error) {
+        throw std::runtime_error("Could not find shard output " +
+                                 partial.data + ".");
+    }
+    if (size != partial.bytes) {
+        throw std::runtime_error("Shard output is incomplete.");
+    }
+    std::ifstream file(partial.data, std::ios::binary);
+    if (!file) throw std::runtime_error("Could not read shard output.");
+
+    // Take the prime off the end of every complete line, then render the
+    // primes again with their global indices.
+    std::string block, text;
+    std::vector<uint64_t> primes;
+    std::size_t carried = 0;
+    const uint64_t before = found;
+    while (file) {
+        block.resize(carried + mergeBlock);
+        file.read(block.data() + carried, mergeBlock);
+        block.resize(carried + static_cast<std::size_t>(file.gcount()));
+
+        std::size_t start = 0;
+        primes.clear();
+        for (std::size_t newline; (newline = block.find('\n', start)) !=
+                                  std::string::npos;
+             start = newline + 1) {
+            std::size_t space = block.rfind(' ', newline);
+            if (space == std::string::npos || space < start) {
+                throw std::runtime_error("Invalid shard output.");
+            }
+            uint64_t prime;
+            auto [end, failure] = std::from_chars(
+                block.data() + space + 1, block.data() + newline, prime);
+            if (failure != std::errc{} || end != block.data() + newline) {
+                throw std::runtime_error("Invalid shard output.");
+            }
+            primes.push_back(prime);
+        }
+
+        text.resize_and_overwrite(
+            primes.size() * maxPrimeLine, [&](char* out, std::size_t) {
+                return formatPrimeLines(out, found, primes.data(),
+                                        primes.size());
+            });
+        output.write(text);
+        found += primes.size();
+
+        carried = block.size() - start;
+        block.erase(0, start);
+    }
+    if (carried || found - before != partial.count) {
+        throw std::runtime_error("Invalid shard output.");
+    }
+}
+
+/**
+ * Combine the partial results of every shard of a job.
+ * @details The shards must all belong to the same job and cover its segments
+ * without gaps or overlaps. Counts are added up; the lines of listing shards
+ * are copied in order with their indices adjusted.
+ * @param paths Partial result files, in any order
+ * @param job Output and memory settings
+ */
+inline void merge(const std::vector<std::string>& paths, const Job& job = {}) {
+    using utils::MemoryBudget;
+    using utils::Partial;
+    using utils::io::openOutput;
+    using utils::math::segmentCount;
+
+    if (paths.empty()) throw std::runtime_error("No partial results given.");
+    std::vector<Partial> partials;
+    for (const auto& path : paths) partials.push_back(Partial::load(path));
+    std::ranges::sort(partials, {}, &Partial::shard);
+
+    // Check that the shards fit together into one job.
+    const Partial& head = partials.front();
+    uint64_t segment = 0;
+    for (std::size_t i = 0; i < partials.size(); i++) {
+        const Partial& partial = partials[i];
+        if (partial.function != head.function ||
+            partial.ceiling != head.ceiling ||
+            partial.shards != partials.size() || partial.shard != i + 1 ||
+            partial.begin != segment || partial.end < partial.begin) {
+            throw std::runtime_error("Partial results do not fit together.");
+        }
+        segment = partial.end;
+    }
+    if (segment != segmentCount(head.ceiling)) {
+        throw std::runtime_error("Partial results do not fit together.");
+    }
+
+    MemoryBudget budget(job.maxMemory);
+    auto output = openOutput(job.output, 0, budget.outputBuffer());
+    uint64_t total = 0;
+    if (head.function == "count") {
+        for (const Partial& partial : partials) total += partial.count;
+        printCount(head.ceiling, total, *output);
+    } else if (head.function == "list") {
+        for (const Partial& partial : partials) {
+            renumber(partial, total, *output);
+            total += partial.count;
+        }
+    } else {
+        throw std::runtime_error("Invalid partial result.");
+    }
+}
+
+} // namespace primal::functions
+
+#endif // PRIMAL_MERGE_HPP
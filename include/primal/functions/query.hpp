@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file query.hpp
+ * @brief Defines a function template that answers a batch of index and test
+ * queries using a cost-based plan.
+ */
+
+#ifndef PRIMAL_QUERY_HPP
+#define PRIMAL_QUERY_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "primal/functions/test.hpp"
+#include "primal/job.hpp"
+#include "primal/utils/io/open-output.hpp"
+#include "primal/utils/math/prime-count-bound.hpp"
+#include "primal/utils/math/primality-test.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/memory-budget.hpp"
+#include "primal/utils/ordered-pipeline.hpp"
+#include "primal/utils/pi-index.hpp"
+#include "primal/utils/query-plan.hpp"
+#include "primal/utils/string/append-integer.hpp"
+#include "primal/utils/uint128.hpp"
+
+namespace primal::functions {
+
+/**
+ * Represents the kinds of question a query can ask.
+ */
+enum class QueryKind {
+    /**
+     * Find the prime with a particular index.
+     */
+    INDEX = 0,
+
+    /**
+     * Find whether a number is a prime.
+     */
+    TEST = 1
+};
+
+/**
+ * A single question about the primes.
+ */
+struct Query {
+    /**
+     * Kind of question.
+     */
+    QueryKind kind;
+
+    /**
+     * Prime index or number to test (of up to 128 bits).
+     */
+    utils::uint128_t value;
+};
+
+/**
+ * Number of tests handed to a worker at a time by the Miller-Rabin engine.
+ */
+inline constexpr std::size_t testBatch = 4096;
+
+/**
+ * Memory needed per query for its position, value, sort key, answer and
+ * output line.
+ */
+inline constexpr std::size_t queryBytes = 2 * sizeof(Query) +
+                                          2 * sizeof(uint64_t) +
+                                          2 * sizeof(std::string) + 128;
+
+/**
+ * Prints the answers to a batch of queries in the order they were given.
+ * @details The index queries are answered from one segmented sweep up to the
+ * largest prime any of them needs, using the prime counts of earlier segments.
+ * With a pi index, those it covers are instead answered by sieving from the
+ * checkpoint just below their prime.
+ * The tests are grouped into clusters by a cost-based planner, and each cluster
+ * is answered by the sweep, by sieving its interval, or by the Miller-Rabin
+ * test, whichever is estimated to be cheapest. Tests of numbers too large for T
+ * are answered straight away by the Baillie-PSW test.
+ * @tparam T Unsigned integer type
+ * @param queries Queries to answer
+ * @param job Output, pi index and memory settings, and whether to print the
+ * plan instead
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+void query(const std::vector<Query>& queries, const Job& job = {}) {
+    using utils::Chunk;
+    using utils::Cluster;
+    using utils::Engine;
+    using utils::MemoryBudget;
+    using utils::explainPlan;
+    using utils::OrderedPipeline;
+    using utils::PiIndex;
+    using utils::planTests;
+    using utils::PrefixSum;
+    using utils::io::openOutput;
+    using utils::math::basePrimeCount;
+    using utils::math::basePrimes;
+    using utils::math::millerRabinTest;
+    using utils::math::nthPrime;
+    using utils::math::maxPrimeIndex;
+    using utils::math::nthPrimeUpperBound;
+    using utils::math::preliminaryCheck;
+    using utils::math::Primality;
+    using utils::math::primalityTest;
+    using utils::math::Segment;
+    using utils::math::segmentBounds;
+    using utils::math::segmentCount;
+    using utils::math::segmentSpan;
+    using utils::string::appendInteger;
+
+    // Every query keeps its position, value and answer.
+    MemoryBudget budget(job.maxMemory);
+    budget.reserve(queries.size() * queryBytes, "the queries");
+
+    // Sort the positions of the index and test queries by magnitude.
+    std::vector<std::size_t> indices, tests;
+    for (std::size_t i = 0; i < queries.size(); i++) {
+        if (queries[i].kind == QueryKind::INDEX && queries[i].value == 0) {
+            throw std::runtime_error("Invalid index.");
+        }
+        if (queries[i].kind == QueryKind::INDEX &&
+            queries[i].value > maxPrimeIndex<T>()) {
+            throw std::runtime_error("Index out of range.");
+        }
+        (queries[i].kind == QueryKind::INDEX ? indices : tests).push_back(i);
+    }
+    auto sortByValue = [&](std::vector<std::size_t>& positions) {
+        // Sorting copies of the values avoids scattered reads of the queries.
+        std::vector<std::pair<utils::uint128_t, std::size_t>> keys;
+        keys.reserve(positions.size());
+        for (std::size_t i : positions) keys.emplace_back(queries[i].value, i);
+        std::sort(keys.begin(), keys.end());
+        for (std::size_t j = 0; j < keys.size(); j++) {
+            positions[j] = keys[j].second;
+        }
+    };
+    sortByValue(indices);
+    sortByValue(tests);
+
+    // Answer the tests that do not need an engine straight away.
+    std::vector<std::string> answers(queries.size());
+    std::size_t direct = std::erase_if(tests, [&](std::size_t i) {
+        if (queries[i].value > std::numeric_limits<T>::max()) {
+            answers[i] = describe(queries[i].value,
+                                  primalityTest(queries[i].value));
+            return true;
+        }
+        T number = static_cast<T>(queries[i].value);
+        if (auto result = preliminaryCheck(number)) {
+            answers[i] = describe(number, *result);
+            return true;
+        }
+        return false;
+    });
+
+    // Index queries within a pi index start from its nearest checkpoint.
+    std::optional<PiIndex> piIndex;
+    std::vector<std::size_t> indexed;
+    if (!job.piIndex.empty()) {
+        piIndex.emplace(job.piIndex);
+        uint64_t covered = piIndex->count(piIndex->size() - 1);
+        auto split = std::upper_bound(
+            indices.begin(), indices.end(), covered,
+            [&](uint64_t value, std::size_t i) {
+                return value < queries[i].value;
+            });
+        indexed.assign(indices.begin(), split);
+        indices.erase(indices.begin(), split);
+    }
+
+    // Plan the remaining tests around the sweep the index queries need.
+    T sweepCeiling = 0;
+    if (!indices.empty()) {
+        auto largest = static_cast<uint64_t>(queries[indices.back()].value);
+        sweepCeiling = nthPrimeUpperBound<T>(largest);
+    }
+    std::vector<T> values;
+    std::vector<uint64_t> planned;
+    for (std::size_t i : tests) {
+        values.push_back(static_cast<T>(queries[i].value));
+        planned.push_back(static_cast<uint64_t>(queries[i].value));
+    }
+    std::vector<Cluster> plan =
+        planTests(planned, sweepCeiling, indices.size());
+    if (!indexed.empty()) {
+        uint64_t step = piIndex->step();
+        uint64_t low = piIndex->locate(queries[indexed.front()].value) * step;
+        uint64_t high = piIndex->locate(queries[indexed.back()].value) * step +
+                        step - 1;
+        double cost = utils::sieveCost(low, low + step / 2) *
+                      static_cast<double>(indexed.size());
+        plan.push_back({Engine::PI_INDEX, low, high, 0, 0, indexed.size(),
+                        cost, 0});
+    }
+    if (job.explain) {
+        openOutput(job.output)->write(explainPlan(plan, direct));
+        return;
+    }
+
+    // The sweep segments come first so that they can count the primes before
+    // them, followed by the windows of sieved clusters and batches of tests.
+    struct Work {
+        Engine engine;
+        T low, high;
+        std::size_t first, last;
+    };
+    std::vector<Work> work;
+    T ceiling = sweepCeiling;
+    for (const Cluster& cluster : plan) {
+        if (cluster.engine == Engine::SIEVE) {
+            T high = static_cast<T>(cluster.high);
+            ceiling = std::max(ceiling, high);
+            for (T low = static_cast<T>(cluster.low) & ~T{1};;) {
+                T end = high - low < segmentSpan
+                            ? high
+                            : static_cast<T>(low + segmentSpan - 1);
+                work.push_back({Engine::SIEVE, low, end, 0, 0});
+                if (end == high) break;
+                low = end + 1;
+            }
+        } else if (cluster.engine == Engine::MILLER_RABIN) {
+            for (std::size_t i = cluster.first; i < cluster.last;
+                 i += testBatch) {
+                work.push_back({Engine::MILLER_RABIN, 0, 0, i,
+                                std::min(i + testBatch, cluster.last)});
+            }
+        } else if (cluster.engine == Engine::PI_INDEX) {
+            ceiling = std::max(ceiling, static_cast<T>(cluster.high));
+            for (std::size_t i = 0; i < indexed.size(); i++) {
+                work.push_back({Engine::PI_INDEX, 0, 0, i, i + 1});
+            }
+        }
+    }
+    const std::size_t sweep = sweepCeiling ? segmentCount(sweepCeiling) : 0;
+
+    // Answer the tests that fall inside a sieved segment.
+    auto answerTests = [&](const Segment<T>& segment) {
+        auto first = std::lower_bound(values.begin(), values.end(),
+                                      segment.low());
+        for (auto it = first; it != values.end() && *it <= segment.high();
+             it++) {
+            bool prime = segment.contains(*it);
+            answers[tests[it - values.begin()]] = describe(
+                *it, prime ? Primality::PRIME : Primality::COMPOSITE);
+        }
+    };
+
+    // Answer an index query with the prime that was found.
+    auto answerIndex = [&](std::size_t i, T prime) {
+        std::string& answer = answers[i];
+        answer = "Prime #";
+        appendInteger(answer, queries[i].value);
+        answer += " = ";
+        appendInteger(answer, prime);
+    };
+
+    if (!work.empty() || sweep) {
+        // Each worker only holds a bitmap.
+        budget.reserve(work.size() * sizeof(Work), "the plan");
+        budget.reserve(basePrimeCount(ceiling) * sizeof(uint32_t),
+                       "the base primes");
+        const auto [workers, slots] = budget.pipeline(segmentSpan / 16, 0);
+
+        const std::vector<uint32_t> primes =
+            ceiling ? basePrimes(ceiling) : std::vector<uint32_t>{};
+        PrefixSum counts;
+
+        OrderedPipeline pipeline(sweep + work.size(), workers, slots);
+        pipeline.run(
+            [&](std::size_t task, Chunk& chunk) {
+                thread_local Segment<T> segment;
+
+                // Run the tasks of the sieved and tested clusters.
+                if (task >= sweep) {
+                    const Work& item = work[task - sweep];
+                    if (item.engine == Engine::SIEVE) {
+                        segment.sieve(item.low, item.high, primes);
+                        answerTests(segment);
+                        return;
+                    }
+                    if (item.engine == Engine::PI_INDEX) {
+                        auto index = static_cast<uint64_t>(
+                            queries[indexed[item.first]].value);
+                        uint64_t k = piIndex->locate(index);
+                        T prime = nthPrime(
+                            static_cast<T>(k * piIndex->step()),
+                            index - piIndex->count(k), primes);
+                        answerIndex(indexed[item.first], prime);
+                        return;
+                    }
+                    for (std::size_t i = item.first; i < item.last; i++) {
+                        answers[tests[i]] =
+                            describe(values[i], millerRabinTest(values[i]));
+                    }
+                    return;
+                }
+
+                T low, high;
+                segmentBounds(task, sweepCeiling, low, high);
+                segment.sieve(low, high, primes);
+                chunk.count = segment.count();
+                counts.publish(task, chunk.count);
+                answerTests(segment);
+
+                // Answer the index queries whose prime is in the segment.
+                uint64_t before = counts.before(task);
+                auto index = std::upper_bound(
+                    indices.begin(), indices.end(), before,
+                    [&](uint64_t value, std::size_t i) {
+                        return value < queries[i].value;
+                    });
+                for (; index != indices.end() &&
+                       queries[*index].value <= before + chunk.count;
+                     index++) {
+                    answerIndex(*index,
+                                segment.nth(static_cast<uint64_t>(
+                                    queries[*index].value - before)));
+                }
+            },
+            [](std::size_t, const Chunk&) {});
+    }
+
+    // Print the answers in the order the queries were given.
+    std::string text;
+    for (const std::string& answer : answers) {
+        if (answer.empty()) throw std::runtime_error("Index out of range.");
+        text += answer;
+        text += '\n';
+    }
+    openOutput(job.output)->write(text);
+}
+
+} // namespace primal::functions
+
+#endif // PRIMAL_QUERY_HPP
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file residues.hpp
+ * @brief Defines a function template that counts the primes up to a ceiling in
+ * every residue class modulo a number.
+ */
+
+#ifndef PRIMAL_RESIDUES_HPP
+#define PRIMAL_RESIDUES_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "primal/job.hpp"
+#include "primal/utils/io/open-output.hpp"
+#include "primal/utils/math/residue-count.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/memory-budget.hpp"
+#include "primal/utils/ordered-pipeline.hpp"
+#include "primal/utils/progress.hpp"
+#include "primal/utils/string/append-integer.hpp"
+
+namespace primal::functions {
+
+/**
+ * Print the number of primes up to a ceiling in every residue class modulo a
+ * number, pi(x; q, a).
+ * @details Worker threads sieve one segment each and count its primes per
+ * class into the segment's output buffer, and the calling thread adds the
+ * buffers to the totals in segment order. With an interval, the running counts
+ * of the classes coprime to q are written as one CSV row whenever a round of
+ * segments ends, instead of the totals.
+ * @tparam T Unsigned integer type
+ * @param ceiling Largest number to count
+ * @param modulus Modulus q of the classes
+ * @param interval Distance between snapshots (rounded down to whole
+ * segments), or 0 for none
+ * @param job Output, progress and memory settings
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+void residues(T ceiling, uint64_t modulus, uint64_t interval,
+              const Job& job = {}) {
+    using utils::MemoryBudget;
+    using utils::OrderedPipeline;
+    using utils::Progress;
+    using utils::io::openOutput;
+    using utils::math::basePrimeCount;
+    using utils::math::basePrimes;
+    using utils::math::maxModulus;
+    using utils::math::ResidueCounter;
+    using utils::math::Segment;
+    using utils::math::segmentBounds;
+    using utils::math::segmentCount;
+    using utils::math::segmentSpan;
+    using utils::string::appendInteger;
+
+    if (modulus == 0 || modulus > maxModulus) {
+        throw std::runtime_error("Invalid modulus.");
+    }
+    const auto q = static_cast<uint32_t>(modulus);
+
+    // Each worker holds a bitmap, its set bits and its own counters.
+    MemoryBudget budget(job.maxMemory);
+    budget.reserve(basePrimeCount(ceiling) * sizeof(uint32_t),
+                   "the base primes");
+    const ResidueCounter counter(q);
+    budget.reserve(counter.bytes(), "the residue classes");
+    const std::size_t classes = counter.classes().size();
+    auto output = openOutput(job.output, 0, budget.outputBuffer());
+    const auto [workers, slots] = budget.pipeline(
+        segmentSpan / 16 +
+            (counter.masked() ? 0 : segmentSpan / 2 * sizeof(uint32_t)),
+        classes * sizeof(uint64_t));
+
+    const std::vector<uint32_t> primes = basePrimes(ceiling);
+    const uint64_t segments = segmentCount(ceiling);
+    Progress progress(ceiling, 0, job.progress);
+
+    // The bitmap leaves out 2 and the classes sharing a factor with q, which
+    // only hold the prime factors of q.
+    std::vector<uint64_t> counts(classes);
+    std::vector<uint32_t> factors;
+    for (uint32_t p = 2, rest = q; p <= rest; p++) {
+        if (rest % p) continue;
+        factors.push_back(p);
+        while (rest % p == 0) rest /= p;
+    }
+    if (int32_t c = counter.index(2 % q); c >= 0 && ceiling >= 2) counts[c]++;
+
+    // Write the header of the snapshot rows.
+    std::string text;
+    if (interval) {
+        text = "x";
+        for (uint32_t a : counter.classes()) {
+            text += ",pi(x;";
+            appendInteger(text, q);
+            text += ',';
+            appendInteger(text, a);
+            text += ')';
+        }
+        text += '\n';
+        output->write(text);
+    }
+
+    // Sieve and count the segments, adding them up in order so that the
+    // running counts can be written at the end of every round.
+    const uint64_t round =
+        interval ? std::max<uint64_t>(1, interval / segmentSpan) : segments;
+    OrderedPipeline<std::vector<uint64_t>> pipeline(segments, workers, slots);
+    pipeline.run(
+        [&](std::size_t task, std::vector<uint64_t>& local) {
+            thread_local Segment<T> segment;
+            T low, high;
+            segmentBounds(task, ceiling, low, high);
+            segment.sieve(low, high, primes);
+            local.assign(classes, 0);
+            counter.add(segment, local.data());
+        },
+        [&](std::size_t task, const std::vector<uint64_t>& local) {
+            for (std::size_t c = 0; c < classes; c++) counts[c] += local[c];
+            uint64_t finished = task + 1;
+            progress.update(finished == segments ? ceiling
+                                                 : finished * segmentSpan);
+            if (!interval || (finished % round && finished != segments)) {
+                return;
+            }
+
+            // Write the running counts at the end of the round.
+            T low, high;
+            segmentBounds(task, ceiling, low, high);
+            text.clear();
+            appendInteger(text, high);
+            for (uint64_t count : counts) {
+                text += ',';
+                appendInteger(text, count);
+            }
+            text += '\n';
+            output->write(text);
+        });
+    if (interval) return;
+
+    // Print every class, including those of the prime factors of q.
+    text.clear();
+    for (uint32_t a = 0; a < q; a++) {
+        uint64_t total = 0;
+        if (int32_t c = counter.index(a); c >= 0) {
+            total = counts[c];
+        } else {
+            for (uint32_t p : factors) total += p <= ceiling && p % q == a;
+        }
+        text += "pi(";
+        appendInteger(text, ceiling);
+        text += "; ";
+        appendInteger(text, q);
+        text += ", ";
+        appendInteger(text, a);
+        text += ") = ";
+        appendInteger(text, total);
+        text += '\n';
+        if (text.size() >= 1 << 16) {
+            output->write(text);
+            text.clear();
+        }
+    }
+    output->write(text);
+}
+
+} // namespace primal::functions
+
+#endif // PRIMAL_RESIDUES_HPP
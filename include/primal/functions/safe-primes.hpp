@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file safe-primes.hpp
+ * @brief Defines a function template that prints the safe primes in a range
+ * together with their Sophie Germain primes.
+ */
+
+#ifndef PRIMAL_SAFE_PRIMES_HPP
+#define PRIMAL_SAFE_PRIMES_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "primal/job.hpp"
+#include "primal/utils/io/open-output.hpp"
+#include "primal/utils/math/safe-prime-sieve.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/memory-budget.hpp"
+#include "primal/utils/ordered-pipeline.hpp"
+#include "primal/utils/progress.hpp"
+#include "primal/utils/string/append-integer.hpp"
+
+namespace primal::functions {
+
+/**
+ * Number of segments handed to the pipeline at a time when only a limited
+ * number of safe primes is wanted.
+ */
+inline constexpr uint64_t safePrimeRound = 64;
+
+/**
+ * Print the safe primes p = 2q + 1 in a range, each followed by its Sophie
+ * Germain prime q, and report the throughput to stderr.
+ * @details Worker threads sieve one segment of candidates q each, crossing off
+ * the multiples of every small prime in q and in 2q + 1 at once, and confirm
+ * the joint survivors. The calling thread writes the segments in order. With a
+ * limit, segments are handed out in rounds so that the search stops soon after
+ * enough safe primes are found.
+ * @tparam T Unsigned integer type of at most 64 bits
+ * @param low Smallest safe prime to print
+ * @param high Largest safe prime to print
+ * @param limit Largest number of safe primes to print, or 0 for all of them
+ * @param job Output, progress and memory settings
+ */
+template <typename T>
+requires std::is_unsigned_v<T> && (sizeof(T) <= sizeof(uint64_t))
+void safePrimes(T low, T high, uint64_t limit, const Job& job = {}) {
+    using utils::Chunk;
+    using utils::MemoryBudget;
+    using utils::OrderedPipeline;
+    using utils::Progress;
+    using utils::io::openOutput;
+    using utils::math::basePrimes;
+    using utils::math::SafePrimeSegment;
+    using utils::math::safeSieveLimit;
+    using utils::math::segmentSpan;
+    using utils::string::appendInteger;
+
+    if (low > high) throw std::runtime_error("Invalid safe prime range.");
+    if (high < 5) return;
+
+    // Candidates q with low <= 2q + 1 <= high, starting at an even number.
+    const T first = static_cast<T>(low < 2 ? 0 : (low - 1) / 2) & ~T{1};
+    const T last = static_cast<T>((high - 1) / 2);
+    const uint64_t segments = (last - first) / segmentSpan + 1;
+
+    // Each worker holds a bitmap and its set bits; each buffer the lines of
+    // the safe primes of one segment.
+    MemoryBudget budget(job.maxMemory);
+    auto output = openOutput(job.output, 0, budget.outputBuffer());
+    const auto [workers, slots] = budget.pipeline(
+        segmentSpan / 16 + segmentSpan / 2 * sizeof(uint32_t), 4096);
+
+    // Sieve with the odd primes up to the limit or the square root of high.
+    const std::vector<uint32_t> primes = basePrimes(
+        std::min<uint64_t>(high, uint64_t{safeSieveLimit} * safeSieveLimit));
+
+    Progress progress(last, first, job.progress);
+    auto started = std::chrono::steady_clock::now();
+    uint64_t printed = 0, survivors = 0, done = 0;
+
+    // The only even Sophie Germain prime, 2, is not part of the bitmap.
+    if (low <= 5) {
+        output->write("5 2\n");
+        printed++;
+    }
+
+    while (done < segments && (!limit || printed < limit)) {
+        uint64_t tasks =
+            limit ? std::min(segments - done, safePrimeRound) : segments;
+        OrderedPipeline pipeline(tasks, workers, slots);
+        pipeline.run(
+            [&](std::size_t task, Chunk& chunk) {
+                thread_local SafePrimeSegment<T> segment;
+                T start = static_cast<T>(first + (done + task) * segmentSpan);
+                T end = last - start < segmentSpan
+                            ? last
+                            : static_cast<T>(start + segmentSpan - 1);
+                segment.sieve(start, end, primes);
+                chunk.count = segment.forEachPrime([&](T q) {
+                    T p = static_cast<T>(2 * q + 1);
+                    if (p < low || p > high) return;
+                    appendInteger(chunk.text, p);
+                    chunk.text += ' ';
+                    appendInteger(chunk.text, q);
+                    chunk.text += '\n';
+                });
+            },
+            [&](std::size_t task, const Chunk& chunk) {
+                survivors += chunk.count;
+                progress.update(
+                    std::min<uint64_t>(last, first + (done + task + 1) *
+                                                         segmentSpan));
+                if (limit && printed >= limit) return;
+
+                // Only write up to the limit.
+                std::size_t cut = 0;
+                while (cut < chunk.text.size() && (!limit || printed < limit)) {
+                    cut = chunk.text.find('\n', cut) + 1;
+                    printed++;
+                }
+                output->write(std::string_view(chunk.text).substr(0, cut));
+            });
+        done += tasks;
+    }
+
+    // Report the throughput in candidates q per second.
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - started)
+                         .count();
+    uint64_t candidates =
+        std::min<uint64_t>(last - first + 1, done * segmentSpan);
+    std::fprintf(stderr,
+                 "Sieved %llu candidates in %.3f s (%.4g per second); "
+                 "%llu survivors were tested.\n",
+                 static_cast<unsigned long long>(candidates), seconds,
+                 static_cast<double>(candidates) / std::max(seconds, 1e-9),
+                 static_cast<unsigned long long>(survivors));
+}
+
+} // namespace primal::functions
+
+#endif // PRIMAL_SAFE_PRIMES_HPP
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file table.hpp
+ * @brief Defines a function template that writes a binary table of an
+ * arithmetic function for every number up to a given ceiling.
+ */
+
+#ifndef PRIMAL_TABLE_HPP
+#define PRIMAL_TABLE_HPP
+
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "primal/job.hpp"
+#include "primal/utils/io/open-output.hpp"
+#include "primal/utils/math/factor-sieve.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/memory-budget.hpp"
+#include "primal/utils/ordered-pipeline.hpp"
+#include "primal/utils/progress.hpp"
+
+namespace primal::functions {
+
+/**
+ * Append the raw bytes of a value to a string.
+ * @tparam U Trivially copyable type
+ * @param text String to append to
+ * @param value Value to append
+ */
+template <typename U>
+void appendBinary(std::string& text, U value) {
+    char bytes[sizeof(U)];
+    std::memcpy(bytes, &value, sizeof(U));
+    text.append(bytes, sizeof(U));
+}
+
+/**
+ * Write a binary table of an arithmetic function for every number from 0 up to
+ * a given ceiling.
+ * @details Entries are written in native byte order using the narrowest width
+ * that fits every value: 32-bit integers for spf and phi when the ceiling fits
+ * in 32 bits (64-bit otherwise), a signed byte for mu and a byte for omega.
+ * Worker threads factor one segment each and the calling thread writes the
+ * segments in order.
+ * @tparam T Unsigned integer type
+ * @param ceiling Largest number to tabulate
+ * @param function Arithmetic function to tabulate
+ * @param job Output, progress and memory settings
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+void table(T ceiling, utils::math::ArithmeticFunction function,
+           const Job& job = {}) {
+    using utils::Chunk;
+    using utils::MemoryBudget;
+    using utils::OrderedPipeline;
+    using utils::Progress;
+    using utils::io::openOutput;
+    using utils::math::ArithmeticFunction;
+    using utils::math::basePrimeCount;
+    using utils::math::basePrimes;
+    using utils::math::FactorSegment;
+    using utils::math::factorSegmentSpan;
+
+    // Each worker holds the factor tables of a segment; each buffer holds its
+    // entries.
+    MemoryBudget budget(job.maxMemory);
+    budget.reserve(basePrimeCount(ceiling) * sizeof(uint32_t),
+                   "the base primes");
+    auto output = openOutput(job.output, 0, budget.outputBuffer());
+    const auto [workers, slots] =
+        budget.pipeline(factorSegmentSpan * (3 * sizeof(T) + 2),
+                        factorSegmentSpan * sizeof(uint64_t));
+
+    Progress progress(ceiling, 0, job.progress);
+    const uint64_t segments = ceiling / factorSegmentSpan + 1;
+    const bool narrow = ceiling <= UINT32_MAX;
+
+    // Calculate the primes needed to factor every segment.
+    const std::vector<uint32_t> primes = basePrimes(ceiling);
+
+    // Factor on the workers, write in order on this thread.
+    OrderedPipeline pipeline(segments, workers, slots);
+    pipeline.run(
+        [&](std::size_t task, Chunk& chunk) {
+            thread_local FactorSegment<T> segment;
+            T low = static_cast<T>(task * factorSegmentSpan);
+            T high = (ceiling - low < factorSegmentSpan)
+                         ? ceiling
+                         : static_cast<T>(low + factorSegmentSpan - 1);
+            segment.sieve(low, high, primes);
+
+            // Render the requested function as binary entries of a given width.
+            auto render = [&](auto width, auto value) {
+                using U = decltype(width);
+                chunk.text.reserve(segment.size() * sizeof(U));
+                for (std::size_t i = 0; i < segment.size(); i++) {
+                    appendBinary(chunk.text, static_cast<U>(value(i)));
+                }
+            };
+
+            auto spf = [&](std::size_t i) { return segment.spf(i); };
+            auto phi = [&](std::size_t i) { return segment.phi(i); };
+            switch (function) {
+            case ArithmeticFunction::SPF:
+                if (narrow) render(uint32_t{}, spf);
+                else render(uint64_t{}, spf);
+                break;
+            case ArithmeticFunction::PHI:
+                if (narrow) render(uint32_t{}, phi);
+                else render(uint64_t{}, phi);
+                break;
+            case ArithmeticFunction::MU:
+                render(int8_t{}, [&](auto i) { return segment.mu(i); });
+                break;
+            case ArithmeticFunction::OMEGA:
+                render(uint8_t{}, [&](auto i) { return segment.omega(i); });
+                break;
+            }
+        },
+        [&](std::size_t task, const Chunk& chunk) {
+            output->write(chunk.text);
+            uint64_t done = (task + 1) * factorSegmentSpan;
+            progress.update(task + 1 == segments ? ceiling : done);
+        });
+}
+
+} // namespace primal::functions
+
+#endif // PRIMAL_TABLE_HPP
@@ -28,35 +28,55 @@
 
 #include <concepts>
 #include <iostream>
+#include <string>
 #include <type_traits>
 #include <vector>
 
 #include "primal/utils/math/primality-test.hpp"
+#include "primal/utils/string/append-integer.hpp"
+#include "primal/utils/uint128.hpp"
 
 namespace primal::functions {
 
 /**
- * Prints whether a given number is a prime.
+ * Describes the outcome of a primality test.
  * @tparam T Unsigned integer type
- * @param number Number to test
+ * @param number Number that was tested
+ * @param primality Outcome of the test
+ * @return Sentence describing the outcome
  */
 template <typename T>
-requires std::is_unsigned_v<T>
-void test(T number) {
+requires utils::UnsignedInteger<T>
+std::string describe(T number, utils::math::Primality primality) {
     using utils::math::Primality;
-    using utils::math::sieveTest;
+    using utils::string::appendInteger;
 
-    switch (sieveTest(number)) {
+    std::string text;
+    appendInteger(text, number);
+    switch (primality) {
     case Primality::PRIME:
-        std::cout << number << " is prime.\n";
+        text += " is prime.";
         break;
     case Primality::COMPOSITE:
-        std::cout << number << " is composite.\n";
-        break;
-    case Primality::NEITHER:
-        std::cout << number << " is neither prime nor composite.\n";
+        text += " is composite.";
         break;
+    default:
+        text += " is neither prime nor composite.";
     }
+    return text;
+}
+
+/**
+ * Prints whether a given number is a prime.
+ * @tparam T Unsigned integer type
+ * @param number Number to test
+ */
+template <typename T>
+requires utils::UnsignedInteger<T>
+void test(T number) {
+    using utils::math::primalityTest;
+
+    std::cout << describe(number, primalityTest(number)) << "\n";
 }
 
 } // namespace primal::functions
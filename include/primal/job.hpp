@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file job.hpp
+ * @brief Defines the settings shared by long-running functions.
+ */
+
+#ifndef PRIMAL_JOB_HPP
+#define PRIMAL_JOB_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "primal/utils/checkpoint.hpp"
+#include "primal/utils/shard.hpp"
+
+namespace primal {
+
+/**
+ * Settings that control how a long-running function is executed.
+ */
+struct Job {
+    /**
+     * File to write output to, or an empty string for stdout.
+     */
+    std::string output;
+
+    /**
+     * State file to record checkpoints in, or an empty string to disable.
+     */
+    std::string state;
+
+    /**
+     * Report progress to stderr periodically, not only on SIGUSR1.
+     */
+    bool progress = false;
+
+    /**
+     * Print the execution plan instead of running it.
+     */
+    bool explain = false;
+
+    /**
+     * File to write a timeline of the run to, or an empty string to disable.
+     */
+    std::string trace;
+
+    /**
+     * Pi index file to start counts and index queries from, or an empty string
+     * to start from zero.
+     */
+    std::string piIndex;
+
+    /**
+     * Largest number of bytes of memory to use, or 0 for no limit.
+     */
+    uint64_t maxMemory = 0;
+
+    /**
+     * Part of the job to run, which covers the whole job by default.
+     */
+    utils::Shard shard;
+
+    /**
+     * Checkpoint to resume from (starts from scratch by default).
+     */
+    utils::Checkpoint resume;
+};
+
+} // namespace primal
+
+#endif // PRIMAL_JOB_HPP
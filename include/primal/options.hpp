@@ -27,8 +27,13 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "cxxopts.hpp"
+#include "primal/functions/query.hpp"
+#include "primal/job.hpp"
+#include "primal/utils/math/factor-sieve.hpp"
+#include "primal/utils/uint128.hpp"
 
 namespace primal {
 
@@ -64,7 +69,57 @@ enum class Function {
     /**
      * Show usage information.
      */
-    HELP = 5
+    HELP = 5,
+
+    /**
+     * Print the number of primes up to a given ceiling.
+     */
+    COUNT = 6,
+
+    /**
+     * Write a binary table of an arithmetic function up to a given ceiling.
+     */
+    TABLE = 7,
+
+    /**
+     * Answer a batch of index and test queries.
+     */
+    QUERY = 8,
+
+    /**
+     * Write a pi index up to a given ceiling.
+     */
+    BUILD_INDEX = 9,
+
+    /**
+     * Print the primes immediately above a given number.
+     */
+    NEXT = 10,
+
+    /**
+     * Print the primes immediately below a given number.
+     */
+    PREV = 11,
+
+    /**
+     * Print the Goldbach partitions of every even number in a range.
+     */
+    GOLDBACH = 12,
+
+    /**
+     * Combine the partial results of the shards of a job.
+     */
+    MERGE = 13,
+
+    /**
+     * Print the safe primes in a range.
+     */
+    SAFE_PRIMES = 14,
+
+    /**
+     * Count the primes in every residue class modulo a number.
+     */
+    RESIDUES = 15
 };
 
 /**
@@ -91,19 +146,91 @@ public:
     Function function;
 
     /**
-     * Argument value for the '--index' option.
+     * Argument value for the '--list' option.
      */
-    uint64_t indexArg;
+    uint64_t listArg;
 
     /**
-     * Argument value for the '--list' option.
+     * Queries from the '--index', '--test' and '--batch' options in the order
+     * given.
      */
-    uint64_t listArg;
+    std::vector<functions::Query> queries;
+
+    /**
+     * Argument value for the '--count' option.
+     */
+    uint64_t countArg;
+
+    /**
+     * Argument value for the '--table' option.
+     */
+    utils::math::ArithmeticFunction tableArg;
 
     /**
-     * Argument value for the '--test' option.
+     * Argument value for the '--ceiling' option.
      */
-    uint64_t testArg;
+    uint64_t ceilingArg;
+
+    /**
+     * Argument value for the '--build-index' option.
+     */
+    uint64_t buildIndexArg;
+
+    /**
+     * Argument value for the '--next' or '--prev' option (of up to 128 bits).
+     */
+    utils::uint128_t adjacentArg;
+
+    /**
+     * Argument value for the '--primes' option.
+     */
+    uint64_t primesArg;
+
+    /**
+     * Smallest number of the range given to the '--goldbach' option.
+     */
+    uint64_t goldbachLowArg;
+
+    /**
+     * Largest number of the range given to the '--goldbach' option.
+     */
+    uint64_t goldbachHighArg;
+
+    /**
+     * Argument value for the '--witnesses' option.
+     */
+    bool witnessesArg;
+
+    /**
+     * Smallest number of the range of the '--safe-primes' option.
+     */
+    uint64_t rangeLowArg;
+
+    /**
+     * Largest number of the range of the '--safe-primes' option.
+     */
+    uint64_t rangeHighArg;
+
+    /**
+     * Argument value for the '--residues' option.
+     */
+    uint64_t residuesArg;
+
+    /**
+     * Argument value for the '--interval' option.
+     */
+    uint64_t intervalArg;
+
+    /**
+     * Argument values for the '--merge' option.
+     */
+    std::vector<std::string> mergeArg;
+
+    /**
+     * Settings for long-running functions from the '--output', '--checkpoint',
+     * '--resume', '--progress', '--explain' and '--pi-index' options.
+     */
+    Job job;
 
 private:
     /**
@@ -119,6 +246,12 @@ private:
      */
     void parseOptions(int argc, char** argv);
 
+    /**
+     * Append the queries listed in a batch file to the queries.
+     * @param path File to read, or "-" for stdin
+     */
+    void readBatch(const std::string& path);
+
     /**
      * Underlying cxxopts instance.
      */
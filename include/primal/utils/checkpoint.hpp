@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file checkpoint.hpp
+ * @brief Defines the progress state of a long-running job and functions that
+ * save it to and load it from a small state file.
+ */
+
+#ifndef PRIMAL_CHECKPOINT_HPP
+#define PRIMAL_CHECKPOINT_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "primal/utils/io/write-sink.hpp"
+#include "primal/utils/string/parse.hpp"
+
+namespace primal::utils {
+
+/**
+ * Progress state of a segmented job at a segment boundary.
+ */
+struct Checkpoint {
+    /**
+     * Name of the function being performed ("list" or "count").
+     */
+    std::string function;
+
+    /**
+     * Largest number to check.
+     */
+    uint64_t ceiling = 0;
+
+    /**
+     * File that output is written to, or an empty string for stdout.
+     */
+    std::string output;
+
+    /**
+     * Number of segments completed.
+     */
+    uint64_t segment = 0;
+
+    /**
+     * Number of primes found in the completed segments.
+     */
+    uint64_t count = 0;
+
+    /**
+     * Number of output bytes written for the completed segments.
+     */
+    uint64_t offset = 0;
+
+    /**
+     * Atomically replace a state file with this checkpoint.
+     * @param path State file to write
+     */
+    void save(const std::string& path) const {
+        std::string text = "function=" + function + "\n" +
+                           "ceiling=" + std::to_string(ceiling) + "\n" +
+                           "output=" + output + "\n" +
+                           "segment=" + std::to_string(segment) + "\n" +
+                           "count=" + std::to_string(count) + "\n" +
+                           "offset=" + std::to_string(offset) + "\n";
+
+        // Write and sync a temporary file, then move it over the old one.
+        std::string temporary = path + ".tmp";
+        {
+            io::WriteSink file(temporary);
+            file.write(text);
+            file.sync();
+        }
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("Could not replace state file.");
+        }
+    }
+
+    /**
+     * Load a checkpoint from a state file.
+     * @param path State file to read
+     * @return Checkpoint stored in the file
+     */
+    static Checkpoint load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) throw std::runtime_error("Could not read state file.");
+
+        // Read the key=value pairs.
+        std::map<std::string, std::string> values;
+        for (std::string line; std::getline(file, line);) {
+            auto separator = line.find('=');
+            if (separator == std::string::npos) continue;
+            values[line.substr(0, separator)] = line.substr(separator + 1);
+        }
+
+        Checkpoint checkpoint;
+        try {
+            checkpoint.function = values.at("function");
+            checkpoint.ceiling = string::parse<uint64_t>(values.at("ceiling"));
+            checkpoint.output = values.at("output");
+            checkpoint.segment = string::parse<uint64_t>(values.at("segment"));
+            checkpoint.count = string::parse<uint64_t>(values.at("count"));
+            checkpoint.offset = string::parse<uint64_t>(values.at("offset"));
+        } catch (const std::out_of_range&) {
+            throw std::runtime_error("State file is incomplete.");
+        }
+        return checkpoint;
+    }
+};
+
+/**
+ * Periodically records the progress of a segmented job in a state file.
+ */
+class Checkpointer {
+public:
+    /**
+     * Prepare to record checkpoints.
+     * @param path State file to write, or an empty string to disable
+     * @param state Checkpoint describing the job and its starting point
+     */
+    Checkpointer(std::string path, Checkpoint state)
+        : path(std::move(path)), state(std::move(state)),
+          last(std::chrono::steady_clock::now()) {}
+
+    /**
+     * Record that every segment before a given one is complete.
+     * @details A checkpoint is only written once the output has been synced,
+     * so resuming never loses or repeats output.
+     * @param segment Number of segments completed
+     * @param count Number of primes found in the completed segments
+     * @param output Output the segments were written to
+     * @param force Write a checkpoint even if the interval has not elapsed
+     */
+    void completed(uint64_t segment, uint64_t count, io::OutputSink& output,
+                   bool force = false) {
+        if (path.empty()) return;
+        auto now = std::chrono::steady_clock::now();
+        if (!force && now - last < interval) return;
+
+        output.sync();
+        state.segment = segment;
+        state.count = count;
+        state.offset = output.offset();
+        state.save(path);
+        last = now;
+    }
+
+private:
+    /**
+     * Minimum time between two checkpoints.
+     */
+    static constexpr std::chrono::seconds interval{10};
+
+    std::string path;
+    Checkpoint state;
+    std::chrono::steady_clock::time_point last;
+};
+
+} // namespace primal::utils
+
+#endif // PRIMAL_CHECKPOINT_HPP
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file mmap-sink.hpp
+ * @brief Defines an output sink that writes a regular file through a sliding
+ * memory-mapped window.
+ */
+
+#ifndef PRIMAL_MMAP_SINK_HPP
+#define PRIMAL_MMAP_SINK_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "primal/utils/io/output-sink.hpp"
+#include "primal/utils/trace.hpp"
+
+namespace primal::utils::io {
+
+/**
+ * Writes a regular file through a sliding memory-mapped window.
+ * @details Each window is preallocated with fallocate() before it is mapped, so
+ * running out of disk space is reported as an error instead of a SIGBUS. Text
+ * is copied straight into the page cache, skipping the copy into the kernel
+ * that write() makes. Finished windows are scheduled for writeback and dropped
+ * with madvise() so the mapping never holds more than one window of memory.
+ * The file is truncated to the bytes actually written when the sink closes.
+ */
+class MmapSink : public OutputSink {
+public:
+    /**
+     * Open the output file.
+     * @param path File to write to
+     * @param offset Number of bytes of an earlier run to keep
+     * @param buffer Largest size of the mapped window
+     */
+    MmapSink(const std::string& path, uint64_t offset, uint64_t buffer)
+        : written(offset), page(static_cast<uint64_t>(::sysconf(_SC_PAGESIZE))),
+          windowSize(std::max(buffer / page, uint64_t{1}) * page) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | (offset ? 0 : O_TRUNC),
+                    0644);
+        if (fd < 0) fail("Could not open output file");
+        if (offset && ::ftruncate(fd, static_cast<off_t>(offset)) < 0) {
+            ::close(fd);
+            fail("Could not resume output file");
+        }
+    }
+
+    ~MmapSink() override {
+        unmap();
+        (void)::ftruncate(fd, static_cast<off_t>(written));
+        ::close(fd);
+    }
+
+    void write(std::string_view text) override {
+        while (!text.empty()) {
+            if (!window || written == windowEnd()) slide();
+
+            std::size_t count = std::min<uint64_t>(text.size(),
+                                                   windowEnd() - written);
+            std::memcpy(window + (written - windowStart), text.data(), count);
+            text.remove_prefix(count);
+            written += count;
+        }
+    }
+
+    void sync() override {
+        trace::Span span("sync");
+        if (window && ::msync(window, windowSize, MS_SYNC) < 0) {
+            fail("Could not sync output");
+        }
+        if (::fdatasync(fd) < 0) fail("Could not sync output");
+    }
+
+    uint64_t offset() const override { return written; }
+
+    /**
+     * Check whether a file can be written through a memory mapping.
+     * @param path File to check
+     * @return True if the file is (or will be created as) a regular file
+     */
+    static bool supports(const std::string& path) {
+        struct stat info;
+        if (::stat(path.c_str(), &info) < 0) return errno == ENOENT;
+        return S_ISREG(info.st_mode);
+    }
+
+private:
+    /**
+     * Offset of the first byte past the mapped window.
+     */
+    uint64_t windowEnd() const { return windowStart + windowSize; }
+
+    /**
+     * Retire the current window and map the one holding the next byte.
+     */
+    void slide() {
+        trace::Span span("map window", "offset", written);
+        unmap();
+
+        // Windows start at a page boundary, which may be before the next byte.
+        windowStart = written / page * page;
+        // posix_fallocate() returns its error instead of setting errno.
+        if (int error = ::posix_fallocate(fd, static_cast<off_t>(windowStart),
+                                          static_cast<off_t>(windowSize))) {
+            errno = error;
+            fail("Could not allocate output file");
+        }
+
+        void* address = ::mmap(nullptr, windowSize, PROT_READ | PROT_WRITE,
+                               MAP_SHARED, fd, static_cast<off_t>(windowStart));
+        if (address == MAP_FAILED) fail("Could not map output file");
+        window = static_cast<char*>(address);
+    }
+
+    /**
+     * Start writing back the current window and release its memory.
+     */
+    void unmap() {
+        if (!window) return;
+        ::msync(window, windowSize, MS_ASYNC);
+        ::madvise(window, windowSize, MADV_DONTNEED);
+        ::munmap(window, windowSize);
+        window = nullptr;
+    }
+
+    int fd;
+    uint64_t written;
+    uint64_t page;
+    uint64_t windowSize;
+    uint64_t windowStart = 0;
+    char* window = nullptr;
+};
+
+} // namespace primal::utils::io
+
+#endif // PRIMAL_MMAP_SINK_HPP
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file open-output.hpp
+ * @brief Defines a function that picks the fastest output sink for a
+ * destination.
+ */
+
+#ifndef PRIMAL_OPEN_OUTPUT_HPP
+#define PRIMAL_OPEN_OUTPUT_HPP
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "primal/utils/io/output-sink.hpp"
+#include "primal/utils/io/write-sink.hpp"
+
+#ifdef __linux__
+#include "primal/utils/io/mmap-sink.hpp"
+#include "primal/utils/io/splice-sink.hpp"
+#endif
+
+namespace primal::utils::io {
+
+/**
+ * Largest amount of memory an output sink buffers unless told otherwise.
+ */
+inline constexpr uint64_t defaultOutputBuffer = uint64_t{64} << 20;
+
+/**
+ * Open the sink best suited to an output destination.
+ * @details Regular files are written through a memory mapping and a pipe on
+ * stdout is fed with vmsplice(). Anything else, such as a terminal, and every
+ * destination on systems other than Linux, uses plain write() calls.
+ * @param path File to write to, or an empty string for stdout
+ * @param offset Number of bytes of an earlier run to keep (files only)
+ * @param buffer Largest amount of memory the sink may buffer
+ * @return Output sink
+ */
+inline std::unique_ptr<OutputSink>
+openOutput(const std::string& path = "", uint64_t offset = 0,
+           uint64_t buffer = defaultOutputBuffer) {
+#ifdef __linux__
+    if (!path.empty() && MmapSink::supports(path)) {
+        return std::make_unique<MmapSink>(path, offset, buffer);
+    }
+
+    struct stat info;
+    if (path.empty() && ::fstat(STDOUT_FILENO, &info) == 0 &&
+        S_ISFIFO(info.st_mode)) {
+        return std::make_unique<SpliceSink>(buffer);
+    }
+#endif
+    return std::make_unique<WriteSink>(path, offset);
+}
+
+} // namespace primal::utils::io
+
+#endif // PRIMAL_OPEN_OUTPUT_HPP
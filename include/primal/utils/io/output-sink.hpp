@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file output-sink.hpp
+ * @brief Declares the interface shared by every destination of program output.
+ */
+
+#ifndef PRIMAL_OUTPUT_SINK_HPP
+#define PRIMAL_OUTPUT_SINK_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace primal::utils::io {
+
+/**
+ * Destination of program output that keeps track of the bytes written.
+ */
+class OutputSink {
+public:
+    OutputSink() = default;
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+    virtual ~OutputSink() = default;
+
+    /**
+     * Write text to the output.
+     * @param text Text to write
+     */
+    virtual void write(std::string_view text) = 0;
+
+    /**
+     * Wait until everything written so far has reached the storage device.
+     * @details Outputs that cannot be synchronized, such as pipes and
+     * terminals, are ignored.
+     */
+    virtual void sync() = 0;
+
+    /**
+     * Total number of bytes in the output, including resumed ones.
+     */
+    virtual uint64_t offset() const = 0;
+
+protected:
+    /**
+     * Throw an error describing the last failed system call.
+     * @param message Description of the failed operation
+     */
+    [[noreturn]] static void fail(const std::string& message) {
+        throw std::runtime_error(message + ": " + std::strerror(errno) + ".");
+    }
+};
+
+} // namespace primal::utils::io
+
+#endif // PRIMAL_OUTPUT_SINK_HPP
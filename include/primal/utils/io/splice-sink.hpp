@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file splice-sink.hpp
+ * @brief Defines an output sink that hands pages to a pipe with vmsplice().
+ */
+
+#ifndef PRIMAL_SPLICE_SINK_HPP
+#define PRIMAL_SPLICE_SINK_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+
+#include "primal/utils/io/output-sink.hpp"
+#include "primal/utils/trace.hpp"
+
+namespace primal::utils::io {
+
+/**
+ * Writes stdout into a pipe by giving the kernel the pages themselves.
+ * @details Text is gathered into a page-aligned buffer, and each full buffer is
+ * gifted to the pipe with vmsplice() instead of being copied. The pipe keeps
+ * referring to those pages for as long as any reader holds them, which may be
+ * long after it has left the pipe if the reader moves it on with splice() or
+ * tee(), so a gifted buffer is never written again: it is unmapped and the next
+ * text goes into a freshly mapped one, backed by a huge page where possible.
+ * Falls back to write(), reusing a single buffer, if the pipe does not accept
+ * vmsplice().
+ */
+class SpliceSink : public OutputSink {
+public:
+    /**
+     * Enlarge the pipe on stdout and map the first buffer.
+     * @param buffer Largest amount of memory to use for the buffers
+     */
+    explicit SpliceSink(uint64_t buffer) {
+        // Ask for a larger pipe; the kernel may grant less, so read it back.
+        auto request = static_cast<int>(
+            std::min<uint64_t>(pipeRequest, std::max<uint64_t>(buffer / 2,
+                                                               4096)));
+        ::fcntl(STDOUT_FILENO, F_SETPIPE_SZ, request);
+        int size = ::fcntl(STDOUT_FILENO, F_GETPIPE_SZ);
+        pipeSize = size > 0 ? static_cast<std::size_t>(size) : 65536;
+
+        // Every flush maps a fresh buffer, which is only cheap with huge pages
+        // (the kernel zeroes one page instead of faulting in hundreds).
+        bufferSize = buffer >= 2 * hugePage
+                         ? hugePage
+                         : std::max<std::size_t>(pipeSize / 2, 4096);
+        map();
+    }
+
+    ~SpliceSink() override {
+        try {
+            flush();
+        } catch (...) {
+            // Destructors must not throw; the reader has gone away.
+        }
+        ::munmap(data, bufferSize);
+    }
+
+    void write(std::string_view text) override {
+        while (!text.empty()) {
+            std::size_t count = std::min(text.size(), bufferSize - filled);
+            std::memcpy(data + filled, text.data(), count);
+            text.remove_prefix(count);
+            filled += count;
+            if (filled == bufferSize) flush();
+        }
+    }
+
+    void sync() override { flush(); }
+
+    uint64_t offset() const override { return spliced + filled; }
+
+private:
+    /**
+     * Largest pipe size requested from the kernel.
+     */
+    static constexpr int pipeRequest = 1 << 20;
+
+    /**
+     * Size of a transparent huge page on common systems.
+     */
+    static constexpr std::size_t hugePage = std::size_t{1} << 21;
+
+    /**
+     * Map a fresh buffer to fill.
+     * @details A huge-page buffer is cut out of a mapping twice its size, so
+     * that it is aligned to a huge page and can be backed by one.
+     */
+    void map() {
+        std::size_t extra = bufferSize == hugePage ? hugePage : 0;
+        void* address = ::mmap(nullptr, bufferSize + extra,
+                               PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (address == MAP_FAILED) throw std::bad_alloc();
+        data = static_cast<char*>(address);
+        if (!extra) return;
+
+        // Trim the mapping down to the aligned buffer.
+        auto start = reinterpret_cast<uintptr_t>(address);
+        uintptr_t aligned = (start + extra - 1) / extra * extra;
+        if (aligned > start) ::munmap(address, aligned - start);
+        if (start + extra > aligned) {
+            ::munmap(data + (aligned - start) + bufferSize,
+                     start + extra - aligned);
+        }
+        data += aligned - start;
+        ::madvise(data, bufferSize, MADV_HUGEPAGE);
+    }
+
+    /**
+     * Hand the filled part of the buffer to the pipe and start a new one if
+     * its pages were gifted.
+     */
+    void flush() {
+        if (!filled) return;
+        trace::Span span("splice", "bytes", filled);
+
+        char* next = data;
+        std::size_t left = filled;
+        bool gifted = false;
+        while (left) {
+            ssize_t count;
+            if (splicing) {
+                iovec chunk{next, left};
+                count = ::vmsplice(STDOUT_FILENO, &chunk, 1, SPLICE_F_GIFT);
+                if (count < 0 && errno == EINVAL) {
+                    splicing = false;
+                    continue;
+                }
+                if (count > 0) gifted = true;
+            } else {
+                count = ::write(STDOUT_FILENO, next, left);
+            }
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                fail("Could not write output");
+            }
+            next += count;
+            left -= static_cast<std::size_t>(count);
+        }
+
+        spliced += filled;
+        filled = 0;
+        if (gifted) {
+            ::munmap(data, bufferSize);
+            map();
+        }
+    }
+
+    std::size_t pipeSize;
+    std::size_t bufferSize;
+    char* data = nullptr;
+    std::size_t filled = 0;
+    uint64_t spliced = 0;
+    bool splicing = true;
+};
+
+} // namespace primal::utils::io
+
+#endif // PRIMAL_SPLICE_SINK_HPP
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file write-sink.hpp
+ * @brief Defines an output sink that writes to a file descriptor using plain
+ * write() calls.
+ */
+
+#ifndef PRIMAL_WRITE_SINK_HPP
+#define PRIMAL_WRITE_SINK_HPP
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "primal/utils/io/output-sink.hpp"
+#include "primal/utils/trace.hpp"
+
+namespace primal::utils::io {
+
+/**
+ * Writes program output to stdout or a file using plain write() calls.
+ * @details Works with every kind of file descriptor, so it is the fallback
+ * when the faster sinks are not available.
+ */
+class WriteSink : public OutputSink {
+public:
+    /**
+     * Open the output.
+     * @param path File to write to, or an empty string for stdout
+     * @param offset Number of bytes of an earlier run to keep (files only)
+     */
+    explicit WriteSink(const std::string& path = "", uint64_t offset = 0)
+        : fd(STDOUT_FILENO), written(offset) {
+        if (path.empty()) return;
+
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | (offset ? 0 : O_TRUNC),
+                    0644);
+        if (fd < 0) fail("Could not open output file");
+
+        // Discard anything written after the point being resumed from.
+        if (offset && (::ftruncate(fd, static_cast<off_t>(offset)) < 0 ||
+                       ::lseek(fd, 0, SEEK_END) < 0)) {
+            fail("Could not resume output file");
+        }
+    }
+
+    ~WriteSink() override {
+        if (fd != STDOUT_FILENO) ::close(fd);
+    }
+
+    void write(std::string_view text) override {
+        trace::Span span("write", "bytes", text.size());
+        while (!text.empty()) {
+            ssize_t count = ::write(fd, text.data(), text.size());
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                fail("Could not write output");
+            }
+            text.remove_prefix(static_cast<std::size_t>(count));
+            written += static_cast<uint64_t>(count);
+        }
+    }
+
+    void sync() override {
+        trace::Span span("sync");
+        if (::fdatasync(fd) < 0 && errno != EINVAL && errno != EROFS) {
+            fail("Could not sync output");
+        }
+    }
+
+    uint64_t offset() const override { return written; }
+
+private:
+    int fd;
+    uint64_t written;
+};
+
+} // namespace primal::utils::io
+
+#endif // PRIMAL_WRITE_SINK_HPP
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file factor-sieve.hpp
+ * @brief Defines a segmented sieve that computes arithmetic functions derived
+ * from the prime factorization of every number in a block.
+ */
+
+#ifndef PRIMAL_FACTOR_SIEVE_HPP
+#define PRIMAL_FACTOR_SIEVE_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "primal/utils/trace.hpp"
+
+namespace primal::utils::math {
+
+/**
+ * Amount of numbers covered by a single factor sieve segment.
+ * @details Every number needs several words of state, so the span is smaller
+ * than the one of the prime sieve to keep a segment inside the L2 cache.
+ */
+inline constexpr uint64_t factorSegmentSpan = uint64_t{1} << 15;
+
+/**
+ * Represents the arithmetic functions that the factor sieve can tabulate.
+ */
+enum class ArithmeticFunction {
+    /**
+     * Smallest prime factor (spf(0) = 0, spf(1) = 1).
+     */
+    SPF = 0,
+
+    /**
+     * Euler's totient function.
+     */
+    PHI = 1,
+
+    /**
+     * Möbius function.
+     */
+    MU = 2,
+
+    /**
+     * Number of distinct prime factors.
+     */
+    OMEGA = 3
+};
+
+/**
+ * A block of consecutive numbers with the arithmetic functions of each number.
+ * @details Every number starts out as its own unfactored remainder. Each base
+ * prime p walks over its multiples (and those of its powers) to divide p out
+ * and update the functions, just like crossing off in a Sieve of Eratosthenes.
+ * Whatever remains above 1 afterwards is a single prime factor larger than the
+ * square root of the number.
+ * @tparam T Unsigned integer type
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+class FactorSegment {
+public:
+    /**
+     * Factor the numbers in the range [low, high].
+     * @param low Smallest number in the segment
+     * @param high Largest number in the segment
+     * @param primes Odd base primes covering at least the square root of high
+     */
+    void sieve(T low, T high, const std::vector<uint32_t>& primes) {
+        trace::Span span("factor", "low", static_cast<uint64_t>(low));
+        low_ = low;
+        std::size_t size = static_cast<std::size_t>(high - low) + 1;
+        remainder.resize(size);
+        spf_.assign(size, 0);
+        phi_.resize(size);
+        mu_.assign(size, 1);
+        omega_.assign(size, 0);
+        for (std::size_t i = 0; i < size; i++) {
+            remainder[i] = phi_[i] = static_cast<T>(low + i);
+        }
+
+        // Divide out every base prime, starting with the even prime 2.
+        divideOut(2, high);
+        for (uint32_t prime : primes) {
+            if (uint64_t{prime} * prime > high) break;
+            divideOut(prime, high);
+        }
+
+        // Account for the single prime factor above the square root, if any.
+        for (std::size_t i = 0; i < size; i++) {
+            T rest = remainder[i];
+            if (rest > 1) {
+                phi_[i] = phi_[i] / rest * (rest - 1);
+                mu_[i] = static_cast<int8_t>(-mu_[i]);
+                omega_[i]++;
+                if (!spf_[i]) spf_[i] = rest;
+            }
+        }
+
+        // Fix up 0 and 1, which have no prime factorization.
+        if (low == 0) {
+            mu_[0] = 0;
+            if (size > 1) spf_[1] = 1;
+        } else if (low == 1) {
+            spf_[0] = 1;
+        }
+    }
+
+    /**
+     * Smallest prime factor of the number at an offset from the segment start.
+     */
+    T spf(std::size_t i) const { return spf_[i]; }
+
+    /**
+     * Euler's totient of the number at an offset from the segment start.
+     */
+    T phi(std::size_t i) const { return phi_[i]; }
+
+    /**
+     * Möbius function of the number at an offset from the segment start.
+     */
+    int8_t mu(std::size_t i) const { return mu_[i]; }
+
+    /**
+     * Number of distinct prime factors of the number at an offset from the
+     * segment start.
+     */
+    uint8_t omega(std::size_t i) const { return omega_[i]; }
+
+    /**
+     * Number of numbers in the segment.
+     */
+    std::size_t size() const { return remainder.size(); }
+
+private:
+    /**
+     * Divide every power of a prime out of its multiples in the segment.
+     * @param prime Prime to divide out
+     * @param high Largest number in the segment
+     */
+    void divideOut(uint64_t prime, T high) {
+        // Update the functions once for every multiple of the prime.
+        for (std::size_t i = firstMultiple(prime); i < size(); i += prime) {
+            remainder[i] /= static_cast<T>(prime);
+            phi_[i] = phi_[i] / static_cast<T>(prime) *
+                      static_cast<T>(prime - 1);
+            mu_[i] = static_cast<int8_t>(-mu_[i]);
+            omega_[i]++;
+            if (!spf_[i]) spf_[i] = static_cast<T>(prime);
+        }
+
+        // Divide out the higher powers, which also rule out squarefreeness.
+        for (uint64_t power = prime * prime; power <= high; power *= prime) {
+            for (std::size_t i = firstMultiple(power); i < size(); i += power) {
+                remainder[i] /= static_cast<T>(prime);
+                mu_[i] = 0;
+            }
+            if (power > high / prime) break;
+        }
+    }
+
+    /**
+     * Offset of the first positive multiple of a number in the segment.
+     * @param factor Number whose multiples to find
+     * @return Offset from the segment start (may be past the end)
+     */
+    std::size_t firstMultiple(uint64_t factor) const {
+        uint64_t start = low_ ? low_ : factor;
+        uint64_t offset = (factor - start % factor) % factor;
+        return static_cast<std::size_t>(start - low_ + offset);
+    }
+
+    T low_ = 0;
+    std::vector<T> remainder;
+    std::vector<T> spf_;
+    std::vector<T> phi_;
+    std::vector<int8_t> mu_;
+    std::vector<uint8_t> omega_;
+};
+
+} // namespace primal::utils::math
+
+#endif // PRIMAL_FACTOR_SIEVE_HPP
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file growable-sieve.hpp
+ * @brief Defines a Sieve of Eratosthenes that keeps its state, so that it can
+ * be extended to a larger ceiling without sieving the covered numbers again.
+ */
+
+#ifndef PRIMAL_GROWABLE_SIEVE_HPP
+#define PRIMAL_GROWABLE_SIEVE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "primal/utils/math/kernels.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/trace.hpp"
+
+namespace primal::utils::math {
+
+/**
+ * A Sieve of Eratosthenes over every number from 0 up to a ceiling that can
+ * grow.
+ * @details Only odd numbers are represented: bit i of the bitmap corresponds
+ * to the number 2i + 1, and a set bit means that the number is prime. Every
+ * odd base prime keeps the bit of its next multiple that has not been crossed
+ * off yet, so extending the ceiling only sieves the new bits, one segment at a
+ * time. Base primes are read back from the bitmap itself, which is first
+ * extended to the square root of the new ceiling if needed.
+ * @tparam T Unsigned integer type
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+class Sieve {
+public:
+    /**
+     * Iterates over the primes of a range in ascending order.
+     */
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        /**
+         * Start at the first prime of a range.
+         * @param words Bitmap of the sieve
+         * @param low Smallest number in the range
+         * @param high Largest number in the range
+         */
+        Iterator(const uint64_t* words, T low, T high)
+            : words(words), two(low <= 2 && high >= 2) {
+            // Only odd numbers from max(low, 3) to high are in the bitmap.
+            T first = std::max(low, T{3});
+            if (first > high) return;
+            std::size_t begin = static_cast<std::size_t>(first / 2);
+            std::size_t end = static_cast<std::size_t>((high - 1) / 2) + 1;
+            if (begin >= end) return;
+            word = begin / 64;
+            lastWord = (end - 1) / 64;
+            lastMask = ~uint64_t{0} >> (63 - (end - 1) % 64);
+            current = words[word] & (~uint64_t{0} << (begin % 64));
+            if (word == lastWord) current &= lastMask;
+            skipEmpty();
+        }
+
+        T operator*() const {
+            if (two) return 2;
+            std::size_t bit = word * 64 + std::countr_zero(current);
+            return static_cast<T>(2 * T(bit) + 1);
+        }
+
+        Iterator& operator++() {
+            if (two) {
+                two = false;
+            } else {
+                current &= current - 1;
+                skipEmpty();
+            }
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        bool operator==(std::default_sentinel_t) const {
+            return !two && !current;
+        }
+
+    private:
+        /**
+         * Move on to the next word with a prime in the range, if any.
+         */
+        void skipEmpty() {
+            while (!current && word < lastWord) {
+                current = words[++word];
+                if (word == lastWord) current &= lastMask;
+            }
+        }
+
+        const uint64_t* words = nullptr;
+        bool two = false;
+        std::size_t word = 0;
+        std::size_t lastWord = 0;
+        uint64_t lastMask = 0;
+        uint64_t current = 0;
+    };
+
+    /**
+     * The primes of a range, viewed in place in the bitmap of a sieve.
+     * @details A view stays valid until the sieve is extended.
+     */
+    class View {
+    public:
+        View(const uint64_t* words, T low, T high)
+            : words(words), low(low), high(high) {}
+
+        Iterator begin() const { return Iterator(words, low, high); }
+        std::default_sentinel_t end() const { return {}; }
+
+    private:
+        const uint64_t* words;
+        T low;
+        T high;
+    };
+
+    /**
+     * Create a sieve that covers no numbers yet.
+     */
+    Sieve() = default;
+
+    /**
+     * Create a sieve that covers every number up to a ceiling.
+     * @param ceiling Largest number to cover
+     */
+    explicit Sieve(T ceiling) { extendTo(ceiling); }
+
+    /**
+     * Sieve every number up to a new ceiling, keeping the numbers already
+     * covered.
+     * @details Does nothing if the ceiling is already covered. Extending from
+     * n to 1.1n sieves only the 0.1n new numbers.
+     * @param ceiling Largest number to cover
+     */
+    void extendTo(T ceiling) {
+        if (covered && ceiling <= ceiling_) return;
+
+        // The base primes up to the square root must be in the bitmap first.
+        T root = isqrt(ceiling);
+        if (root >= 3 && (!covered || ceiling_ < root)) extendTo(root);
+
+        trace::Span span("extend", "ceiling", static_cast<uint64_t>(ceiling));
+        const std::size_t oldBits = bits;
+        const std::size_t newBits =
+            static_cast<std::size_t>(ceiling / 2 + ceiling % 2);
+
+        // Mark the new odd numbers as prime, then rule out 1 if it is new.
+        words_.resize((newBits + 63) / 64);
+        std::size_t fresh = (oldBits + 63) / 64;
+        if (oldBits % 64) {
+            std::size_t end = std::min(newBits, fresh * 64);
+            uint64_t mask = ~uint64_t{0} << (oldBits % 64);
+            if (end % 64) mask &= ~uint64_t{0} >> (64 - end % 64);
+            words_[oldBits / 64] |= mask;
+        }
+        if (newBits > fresh * 64) {
+            kernels::fillBits(words_.data() + fresh, newBits - fresh * 64);
+        }
+        if (!oldBits && newBits) words_[0] &= ~uint64_t{1};
+        bits = newBits;
+        ceiling_ = ceiling;
+        covered = true;
+
+        // Take on the base primes whose squares enter the sieve.
+        if (root >= 3) {
+            std::size_t bit = primes_.empty() ? 1 : primes_.back() / 2 + 1;
+            for (; bit <= static_cast<std::size_t>((root - 1) / 2); bit++) {
+                if (!((words_[bit / 64] >> (bit % 64)) & 1)) continue;
+                uint64_t prime = 2 * uint64_t{bit} + 1;
+                primes_.push_back(static_cast<uint32_t>(prime));
+                offsets.push_back((prime * prime - 1) / 2);
+            }
+        }
+
+        // Cross off the new bits one cache-sized segment at a time.
+        constexpr std::size_t segmentBits = segmentSpan / 2;
+        for (std::size_t low = oldBits / 64 * 64; low < newBits;
+             low += segmentBits) {
+            std::size_t size = std::min(segmentBits, newBits - low);
+            uint64_t* words = words_.data() + low / 64;
+            for (std::size_t i = 0; i < primes_.size(); i++) {
+                uint64_t offset = offsets[i];
+                if (offset >= low + size) continue;
+                std::size_t prime = primes_[i];
+                std::size_t start = static_cast<std::size_t>(offset - low);
+                kernels::crossOff(words, size, start, prime);
+                offsets[i] = low + start + (size - start + prime - 1) / prime *
+                                               prime;
+            }
+        }
+    }
+
+    /**
+     * Check whether a covered number is prime in constant time.
+     * @param number Number up to the ceiling
+     * @return True if prime, false otherwise
+     */
+    bool isPrime(T number) const {
+        if (!covered || number > ceiling_) {
+            throw std::runtime_error("Number is not covered by the sieve.");
+        }
+        if (number == 2) return true;
+        if (number % 2 == 0) return false;
+        auto bit = static_cast<std::size_t>(number / 2);
+        return (words_[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    /**
+     * View the primes in a covered range.
+     * @param low Smallest number in the range
+     * @param high Largest number in the range, at most the ceiling
+     * @return Range of the primes in [low, high] in ascending order
+     */
+    View primesIn(T low, T high) const {
+        if (!covered || high > ceiling_) {
+            throw std::runtime_error("Range is not covered by the sieve.");
+        }
+        return View(words_.data(), low, high);
+    }
+
+    /**
+     * Largest number covered by the sieve.
+     */
+    T ceiling() const { return ceiling_; }
+
+    /**
+     * Odd base primes, covering the square root of the ceiling.
+     */
+    const std::vector<uint32_t>& basePrimes() const { return primes_; }
+
+private:
+    /**
+     * Whether any number is covered yet.
+     */
+    bool covered = false;
+
+    /**
+     * Largest number covered.
+     */
+    T ceiling_ = 0;
+
+    /**
+     * Number of odd numbers represented in the bitmap.
+     */
+    std::size_t bits = 0;
+
+    /**
+     * Bitmap of odd numbers, where a set bit marks a prime.
+     */
+    std::vector<uint64_t> words_;
+
+    /**
+     * Odd base primes in ascending order.
+     */
+    std::vector<uint32_t> primes_;
+
+    /**
+     * Bit of the next multiple of every base prime that is not crossed off.
+     */
+    std::vector<uint64_t> offsets;
+};
+
+} // namespace primal::utils::math
+
+#endif // PRIMAL_GROWABLE_SIEVE_HPP
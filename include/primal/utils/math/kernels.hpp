@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file kernels.hpp
+ * @brief Declares the hot loops of the sieve, which are built for several
+ * instruction sets and selected at startup.
+ * @details On x86-64 every kernel is compiled for the x86-64-v2 (SSE4.2 and
+ * POPCNT), x86-64-v3 (AVX2) and x86-64-v4 (AVX-512) levels as well as the
+ * baseline. The dynamic loader picks the best variant for the running CPU once
+ * (via cpuid), so a single portable binary runs at full speed everywhere.
+ */
+
+#ifndef PRIMAL_KERNELS_HPP
+#define PRIMAL_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace primal::utils::math::kernels {
+
+/**
+ * Maximum number of characters written by formatPrimeLines() per line.
+ */
+inline constexpr std::size_t maxPrimeLine = 52;
+
+/**
+ * Set every bit of a bitmap below a given count and clear the padding bits.
+ * @param words Bitmap to fill
+ * @param bits Number of bits to set
+ */
+void fillBits(uint64_t* words, std::size_t bits);
+
+/**
+ * Clear every step-th bit of a bitmap starting at a given bit.
+ * @details Odd steps are handled by one of 32 unrolled kernels, chosen by the
+ * step and the starting bit modulo 8, that clear eight bits per pass.
+ * @param words Bitmap to update
+ * @param bits Number of bits in the bitmap
+ * @param start Index of the first bit to clear
+ * @param step Distance between cleared bits
+ */
+void crossOff(uint64_t* words, std::size_t bits, std::size_t start,
+              std::size_t step);
+
+/**
+ * Count the set bits of a bitmap.
+ * @param words Bitmap to count
+ * @param count Number of words in the bitmap
+ * @return Number of set bits
+ */
+uint64_t popcount(const uint64_t* words, std::size_t count);
+
+/**
+ * Count the bits set in both of two bitmaps, reading the second one from a bit
+ * offset.
+ * @param first First bitmap
+ * @param second Second bitmap, with one readable word past the compared ones
+ * @param shift Bit offset into the second bitmap (below 64)
+ * @param count Number of words of the first bitmap to compare
+ * @return Number of bits set in both bitmaps
+ */
+uint64_t andPopcount(const uint64_t* first, const uint64_t* second,
+                     unsigned shift, std::size_t count);
+
+/**
+ * Count the set bits of a bitmap under each of several masks that repeat with
+ * a period.
+ * @details Word i is compared with the row of masks for phase
+ * (phase + i * stride) mod period, which holds one mask per counter.
+ * @param words Bitmap to count
+ * @param count Number of words in the bitmap
+ * @param masks Rows of masks, one row per phase
+ * @param classes Number of masks per row and of counters
+ * @param period Number of rows
+ * @param phase Row of the first word
+ * @param stride Rows to advance per word (below the period)
+ * @param counts Counters to add the set bits under every mask to
+ */
+void maskedPopcount(const uint64_t* words, std::size_t count,
+                    const uint64_t* masks, std::size_t classes,
+                    std::size_t period, std::size_t phase, std::size_t stride,
+                    uint64_t* counts);
+
+/**
+ * Find the indices of the set bits of a bitmap in ascending order.
+ * @param words Bitmap to scan
+ * @param count Number of words in the bitmap
+ * @param indices Output array with room for every set bit
+ * @return Number of indices written
+ */
+std::size_t extractBits(const uint64_t* words, std::size_t count,
+                        uint32_t* indices);
+
+/**
+ * Render "Prime #i = p" lines for consecutive primes.
+ * @param out Output buffer with room for maxPrimeLine characters per prime
+ * @param index Index of the prime before the first one
+ * @param primes Primes to render
+ * @param count Number of primes
+ * @return Number of characters written
+ */
+std::size_t formatPrimeLines(char* out, uint64_t index, const uint64_t* primes,
+                             std::size_t count);
+
+/**
+ * Get the name of the instruction set level selected for the running CPU.
+ * @return Instruction set level name
+ */
+const char* instructionSet();
+
+} // namespace primal::utils::math::kernels
+
+#endif // PRIMAL_KERNELS_HPP
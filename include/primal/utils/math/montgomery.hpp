@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file montgomery.hpp
+ * @brief Defines modular arithmetic in Montgomery form for odd 64-bit and
+ * 128-bit moduli.
+ */
+
+#ifndef PRIMAL_MONTGOMERY_HPP
+#define PRIMAL_MONTGOMERY_HPP
+
+#include <cstdint>
+
+#include "primal/utils/uint128.hpp"
+
+namespace primal::utils::math {
+
+/**
+ * Multiplies residues modulo an odd number without dividing.
+ * @details A residue a is stored as a * 2^64 mod n, which turns every modular
+ * multiplication into two full-width multiplications and a subtraction.
+ */
+class Montgomery {
+public:
+    /**
+     * Prepare arithmetic modulo a number.
+     * @param modulus Odd modulus greater than 1
+     */
+    explicit Montgomery(uint64_t modulus) : n(modulus) {
+        // Newton's iteration doubles the correct low bits of the inverse.
+        inverse = n;
+        for (int i = 0; i < 5; i++) inverse *= 2 - n * inverse;
+
+        one_ = -n % n;
+        square = static_cast<uint64_t>(static_cast<uint128_t>(one_) *
+                                       one_ % n);
+    }
+
+    /**
+     * Convert a number to Montgomery form.
+     * @param value Number less than the modulus
+     * @return Residue in Montgomery form
+     */
+    uint64_t to(uint64_t value) const { return multiply(value, square); }
+
+    /**
+     * Multiply two residues in Montgomery form.
+     * @param a First residue
+     * @param b Second residue
+     * @return Product in Montgomery form
+     */
+    uint64_t multiply(uint64_t a, uint64_t b) const {
+        return reduce(static_cast<uint128_t>(a) * b);
+    }
+
+    /**
+     * Raise a residue to a power.
+     * @param base Residue in Montgomery form
+     * @param exponent Exponent
+     * @return Power in Montgomery form
+     */
+    uint64_t power(uint64_t base, uint64_t exponent) const {
+        uint64_t result = one_;
+        for (; exponent; exponent >>= 1) {
+            if (exponent & 1) result = multiply(result, base);
+            base = multiply(base, base);
+        }
+        return result;
+    }
+
+    /**
+     * The residue 1 in Montgomery form.
+     */
+    uint64_t one() const { return one_; }
+
+    /**
+     * The residue -1 in Montgomery form.
+     */
+    uint64_t minusOne() const { return n - one_; }
+
+private:
+    /**
+     * Divide by 2^64 modulo n.
+     * @param value Product of two residues
+     * @return Reduced residue
+     */
+    uint64_t reduce(uint128_t value) const {
+        // The low halves cancel because q * n = value (mod 2^64).
+        uint64_t q = static_cast<uint64_t>(value) * inverse;
+        uint64_t high = static_cast<uint64_t>(value >> 64);
+        uint64_t cancel = static_cast<uint64_t>(
+            (static_cast<uint128_t>(q) * n) >> 64);
+        return high >= cancel ? high - cancel : high - cancel + n;
+    }
+
+    uint64_t n;
+    uint64_t inverse;
+    uint64_t one_;
+    uint64_t square;
+};
+
+/**
+ * Multiplies residues modulo an odd 128-bit number without dividing.
+ * @details Works like Montgomery with R = 2^128. Each product of two residues
+ * is assembled from four 64-bit multiplications, and the reduction needs the
+ * high half of one more such product. Addition, subtraction and halving are
+ * provided as well, since they commute with the Montgomery form.
+ */
+class Montgomery128 {
+public:
+    /**
+     * Prepare arithmetic modulo a number.
+     * @param modulus Odd modulus greater than 1
+     */
+    explicit Montgomery128(uint128_t modulus) : n(modulus) {
+        // Newton's iteration doubles the correct low bits of the inverse.
+        inverse = n;
+        for (int i = 0; i < 6; i++) inverse *= 2 - n * inverse;
+
+        // R^2 mod n is R mod n doubled another 128 times.
+        one_ = -n % n;
+        square = one_;
+        for (int i = 0; i < 128; i++) square = add(square, square);
+    }
+
+    /**
+     * Convert a number to Montgomery form.
+     * @param value Number less than the modulus
+     * @return Residue in Montgomery form
+     */
+    uint128_t to(uint128_t value) const { return multiply(value, square); }
+
+    /**
+     * Multiply two residues in Montgomery form.
+     * @param a First residue
+     * @param b Second residue
+     * @return Product in Montgomery form
+     */
+    uint128_t multiply(uint128_t a, uint128_t b) const {
+        uint128_t high, low;
+        wideMultiply(a, b, high, low);
+
+        // The low halves cancel because q * n = a * b (mod 2^128).
+        uint128_t q = low * inverse, cancel, ignored;
+        wideMultiply(q, n, cancel, ignored);
+        return high >= cancel ? high - cancel : high - cancel + n;
+    }
+
+    /**
+     * Add two residues.
+     * @param a First residue
+     * @param b Second residue
+     * @return Sum modulo n
+     */
+    uint128_t add(uint128_t a, uint128_t b) const {
+        uint128_t sum = a + b;
+        return sum < a || sum >= n ? sum - n : sum;
+    }
+
+    /**
+     * Subtract a residue from another.
+     * @param a First residue
+     * @param b Second residue
+     * @return Difference modulo n
+     */
+    uint128_t subtract(uint128_t a, uint128_t b) const {
+        return a >= b ? a - b : a - b + n;
+    }
+
+    /**
+     * Halve a residue.
+     * @param a Residue
+     * @return a / 2 modulo n
+     */
+    uint128_t half(uint128_t a) const {
+        return a & 1 ? (a >> 1) + (n >> 1) + 1 : a >> 1;
+    }
+
+    /**
+     * Raise a residue to a power.
+     * @param base Residue in Montgomery form
+     * @param exponent Exponent
+     * @return Power in Montgomery form
+     */
+    uint128_t power(uint128_t base, uint128_t exponent) const {
+        uint128_t result = one_;
+        for (; exponent; exponent >>= 1) {
+            if (exponent & 1) result = multiply(result, base);
+            base = multiply(base, base);
+        }
+        return result;
+    }
+
+    /**
+     * The residue 1 in Montgomery form.
+     */
+    uint128_t one() const { return one_; }
+
+    /**
+     * The residue -1 in Montgomery form.
+     */
+    uint128_t minusOne() const { return n - one_; }
+
+private:
+    /**
+     * Multiply two 128-bit numbers into a 256-bit product.
+     * @param a First factor
+     * @param b Second factor
+     * @param high High half of the product
+     * @param low Low half of the product
+     */
+    static void wideMultiply(uint128_t a, uint128_t b, uint128_t& high,
+                             uint128_t& low) {
+        auto a0 = static_cast<uint64_t>(a), a1 = static_cast<uint64_t>(a >> 64);
+        auto b0 = static_cast<uint64_t>(b), b1 = static_cast<uint64_t>(b >> 64);
+        uint128_t p00 = static_cast<uint128_t>(a0) * b0;
+        uint128_t p01 = static_cast<uint128_t>(a0) * b1;
+        uint128_t p10 = static_cast<uint128_t>(a1) * b0;
+        uint128_t p11 = static_cast<uint128_t>(a1) * b1;
+
+        // The middle column sums to less than 3 * 2^64, so it cannot overflow.
+        uint128_t middle = (p00 >> 64) + static_cast<uint64_t>(p01) +
+                           static_cast<uint64_t>(p10);
+        low = (middle << 64) | static_cast<uint64_t>(p00);
+        high = p11 + (p01 >> 64) + (p10 >> 64) + (middle >> 64);
+    }
+
+    uint128_t n;
+    uint128_t inverse;
+    uint128_t one_;
+    uint128_t square;
+};
+
+} // namespace primal::utils::math
+
+#endif // PRIMAL_MONTGOMERY_HPP
@@ -25,12 +25,17 @@
 #ifndef PRIMAL_PRIMALITY_TEST_HPP
 #define PRIMAL_PRIMALITY_TEST_HPP
 
+#include <bit>
 #include <concepts>
+#include <cstdint>
 #include <optional>
 #include <type_traits>
 #include <vector>
 
-#include "primal/utils/math/sieve.hpp"
+#include "primal/utils/math/growable-sieve.hpp"
+#include "primal/utils/math/montgomery.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/uint128.hpp"
 
 namespace primal::utils::math {
 
@@ -84,7 +89,7 @@ Primality divisionTest(T number) {
     if (auto result = preliminaryCheck(number)) return *result;
 
     // Test remaining numbers using trial division.
-    for (T i = 5; i * i < number; i += 6) {
+    for (T i = 5; i <= number / i; i += 6) {
         if (!(number % i) || !(number % (i + 2))) return Primality::COMPOSITE;
     }
 
@@ -93,27 +98,217 @@ Primality divisionTest(T number) {
 }
 
 /**
- * Performs a primality test on a number using a Sieve of Eratosthenes.
- * @tparam T Unsigned integer type
+ * Performs a primality test on a number using the Miller-Rabin test.
+ * @details The seven bases found by Jim Sinclair make the test deterministic
+ * for every number below 2^64. The modular arithmetic is done in Montgomery
+ * form.
+ * @tparam T Unsigned integer type of at most 64 bits
  * @param number Number to test
  * @return Primality enum of test outcome
  */
 template <typename T>
-requires std::is_unsigned_v<T>
-Primality sieveTest(T number) {
+requires std::is_unsigned_v<T> && (sizeof(T) <= sizeof(uint64_t))
+Primality millerRabinTest(T number) {
     // Filter out easy-to-categorize numbers.
     if (auto result = preliminaryCheck(number)) return *result;
 
-    // Test remaining numbers using a Sieve of Eratosthenes.
-    std::vector<T> primes;
+    // Write n - 1 as d * 2^s with d odd.
+    uint64_t n = number;
+    uint64_t d = n - 1;
+    int s = std::countr_zero(d);
+    d >>= s;
+
+    const Montgomery mont(n);
+    for (uint64_t base : {2, 325, 9375, 28178, 450775, 9780504, 1795265022}) {
+        base %= n;
+        if (!base) continue;
+
+        // A prime has x = 1, or reaches -1 while squaring x up to s - 1 times.
+        uint64_t x = mont.power(mont.to(base), d);
+        if (x == mont.one() || x == mont.minusOne()) continue;
+        int i = 1;
+        for (; i < s; i++) {
+            x = mont.multiply(x, x);
+            if (x == mont.minusOne()) break;
+        }
+        if (i == s) return Primality::COMPOSITE;
+    }
+
+    return Primality::PRIME;
+}
+
+/**
+ * Calculates the Jacobi symbol (a / n).
+ * @param a Numerator
+ * @param n Odd positive denominator
+ * @return -1, 0 or 1
+ */
+inline int jacobi(uint128_t a, uint128_t n) {
+    int result = 1;
+    a %= n;
+    while (a) {
+        // Take out factors of 2, using (2 / n) = -1 for n = 3 or 5 (mod 8).
+        auto low = static_cast<uint64_t>(a);
+        int twos = low ? std::countr_zero(low)
+                       : 64 + std::countr_zero(static_cast<uint64_t>(a >> 64));
+        a >>= twos;
+        uint64_t r = static_cast<uint64_t>(n % 8);
+        if ((twos & 1) && (r == 3 || r == 5)) result = -result;
+
+        // Flip by quadratic reciprocity, negating if both are 3 (mod 4).
+        if (a % 4 == 3 && n % 4 == 3) result = -result;
+        uint128_t rest = n % a;
+        n = a;
+        a = rest;
+    }
+    return n == 1 ? result : 0;
+}
+
+/**
+ * Performs a primality test on a 128-bit number using the Baillie-PSW test.
+ * @details Combines a strong probable prime test to base 2 with a strong Lucas
+ * probable prime test using Selfridge's parameters. No composite passing both
+ * is known, and none exists below 2^64. All arithmetic modulo the number is
+ * done in 128-bit Montgomery form.
+ * @param number Number to test
+ * @return Primality enum of test outcome
+ */
+inline Primality bpswTest(uint128_t number) {
+    // Filter out easy-to-categorize numbers and small factors.
+    if (auto result = preliminaryCheck(number)) return *result;
+    for (uint32_t prime : {5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47}) {
+        if (number % prime == 0) {
+            return number == prime ? Primality::PRIME : Primality::COMPOSITE;
+        }
+    }
+
+    const uint128_t n = number;
+    const Montgomery128 mont(n);
 
-    // If the final element in the vector is the number, then it is prime.
-    if (!primes.empty() && primes.back() == number) return Primality::PRIME;
+    // Strong probable prime test to base 2, with n - 1 = d * 2^s and d odd.
+    uint128_t d = n - 1;
+    int s = 0;
+    for (; !(d & 1); s++) d >>= 1;
+    uint128_t x = mont.power(mont.add(mont.one(), mont.one()), d);
+    if (x != mont.one() && x != mont.minusOne()) {
+        int i = 1;
+        for (; i < s; i++) {
+            x = mont.multiply(x, x);
+            if (x == mont.minusOne()) break;
+        }
+        if (i >= s) return Primality::COMPOSITE;
+    }
+
+    // A square has no D with (D / n) = -1, so rule squares out first.
+    uint128_t root = isqrt(n);
+    if (root * root == n) return Primality::COMPOSITE;
+
+    // Find the first D of 5, -7, 9, -11, ... with (D / n) = -1.
+    int64_t D = 5;
+    for (;; D = D > 0 ? -(D + 2) : -D + 2) {
+        auto magnitude = static_cast<uint128_t>(D > 0 ? D : -D);
+        int symbol = jacobi(D > 0 ? magnitude : n - magnitude % n, n);
+        if (symbol == -1) break;
+        if (symbol == 0 && magnitude != n) {
+            return Primality::COMPOSITE;
+        }
+    }
 
-    // The number must be composite if the Sieve didn't generate it.
+    // P = 1 and Q = (1 - D) / 4, in Montgomery form.
+    auto toResidue = [&](int64_t value) {
+        uint128_t magnitude =
+            mont.to(static_cast<uint128_t>(value > 0 ? value : -value) % n);
+        return value >= 0 ? magnitude : mont.subtract(0, magnitude);
+    };
+    const uint128_t dm = toResidue(D);
+    const uint128_t qm = toResidue((1 - D) / 4);
+
+    // Compute U_k, V_k and Q^k for k = n + 1 = d * 2^s with d odd.
+    d = n + 1;
+    s = 0;
+    for (; !(d & 1); s++) d >>= 1;
+    uint128_t u = mont.one(), v = mont.one(), qk = qm;
+    int top = 127;
+    while (!((d >> top) & 1)) top--;
+    for (int bit = top - 1; bit >= 0; bit--) {
+        // Double k: U_2k = U_k V_k, V_2k = V_k^2 - 2 Q^k.
+        u = mont.multiply(u, v);
+        v = mont.subtract(mont.multiply(v, v), mont.add(qk, qk));
+        qk = mont.multiply(qk, qk);
+        if ((d >> bit) & 1) {
+            // Increment k: U_k+1 = (U_k + V_k) / 2, V_k+1 = (D U_k + V_k) / 2.
+            uint128_t next = mont.half(mont.add(u, v));
+            v = mont.half(mont.add(mont.multiply(dm, u), v));
+            u = next;
+            qk = mont.multiply(qk, qm);
+        }
+    }
+
+    // A strong Lucas probable prime has U_d = 0 or V_(d 2^r) = 0, r < s.
+    if (u == 0) return Primality::PRIME;
+    for (int r = 0; r < s; r++) {
+        if (v == 0) return Primality::PRIME;
+        v = mont.subtract(mont.multiply(v, v), mont.add(qk, qk));
+        qk = mont.multiply(qk, qk);
+    }
     return Primality::COMPOSITE;
 }
 
+/**
+ * Performs a primality test on a number of any width with the fastest
+ * suitable test.
+ * @details Numbers that fit in 64 bits use the deterministic Miller-Rabin
+ * test; larger ones use the Baillie-PSW test.
+ * @tparam T Unsigned integer type, including uint128_t
+ * @param number Number to test
+ * @return Primality enum of test outcome
+ */
+template <typename T>
+requires UnsignedInteger<T>
+Primality primalityTest(T number) {
+    if constexpr (sizeof(T) <= sizeof(uint64_t)) {
+        return millerRabinTest(number);
+    } else {
+        if (number <= UINT64_MAX) {
+            return millerRabinTest(static_cast<uint64_t>(number));
+        }
+        return bpswTest(number);
+    }
+}
+
+/**
+ * Performs a primality test on a number using a Sieve of Eratosthenes that is
+ * kept between tests.
+ * @details The sieve is only extended past its ceiling, so testing numbers
+ * in ascending order sieves every number once.
+ * @tparam T Unsigned integer type
+ * @param number Number to test
+ * @param sieve Sieve to extend up to the number
+ * @return Primality enum of test outcome
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+Primality sieveTest(T number, Sieve<T>& sieve) {
+    // Filter out easy-to-categorize numbers.
+    if (auto result = preliminaryCheck(number)) return *result;
+
+    sieve.extendTo(number);
+    return sieve.isPrime(number) ? Primality::PRIME : Primality::COMPOSITE;
+}
+
+/**
+ * Performs a primality test on a number using a Sieve of Eratosthenes.
+ * @tparam T Unsigned integer type
+ * @param number Number to test
+ * @return Primality enum of test outcome
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+Primality sieveTest(T number) {
+    Sieve<T> sieve;
+    return sieveTest(number, sieve);
+}
+
 /**
  * Checks whether a number is prime or not using a Sieve of Eratosthenes.
  * @tparam T Unsigned integer type
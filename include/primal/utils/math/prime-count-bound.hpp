@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file prime-count-bound.hpp
+ * @brief Defines function templates that bound the number of primes up to a
+ * given ceiling and the value of the prime with a given index.
+ */
+
+#ifndef PRIMAL_PRIME_COUNT_BOUND_HPP
+#define PRIMAL_PRIME_COUNT_BOUND_HPP
+
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace primal::utils::math {
+
+/**
+ * Calculates an upper bound for the number of primes up to a given ceiling.
+ * @details Uses Dusart's bound pi(x) <= x / ln(x) * (1 + 1.2762 / ln(x)),
+ * which holds for every x > 1.
+ * @tparam T Unsigned integer type
+ * @param ceiling Largest number to count
+ * @return Upper bound for pi(ceiling)
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+std::size_t primeCountUpperBound(T ceiling) {
+    if (ceiling < 2) return 0;
+    if (ceiling < 17) return 6;
+
+    long double x = ceiling;
+    long double ln = std::log(x);
+    return static_cast<std::size_t>(x / ln * (1 + 1.2762 / ln)) + 1;
+}
+
+/**
+ * Gets the number of primes that fit in an unsigned integer type.
+ * @tparam T Unsigned integer type of at most 64 bits
+ * @return pi of the largest value of T, the largest valid prime index
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+constexpr uint64_t maxPrimeIndex() {
+    constexpr int bits = std::numeric_limits<T>::digits;
+    static_assert(bits == 8 || bits == 16 || bits == 32 || bits == 64);
+    if constexpr (bits == 8) return 54;
+    else if constexpr (bits == 16) return 6542;
+    else if constexpr (bits == 32) return 203280221;
+    else return 425656284035217743;
+}
+
+/**
+ * Calculates an upper bound for the prime with a particular index.
+ * @details Uses Rosser's bound p(n) < n * (ln(n) + ln(ln(n))), which holds for
+ * every n >= 6.
+ * @tparam T Unsigned integer type
+ * @param index One-based prime index
+ * @return Upper bound for the prime, saturated at the largest value of T
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+T nthPrimeUpperBound(uint64_t index) {
+    if (index < 6) return 13;
+
+    long double n = index;
+    long double bound = n * (std::log(n) + std::log(std::log(n)));
+    if (bound >= static_cast<long double>(std::numeric_limits<T>::max())) {
+        return std::numeric_limits<T>::max();
+    }
+    return static_cast<T>(bound);
+}
+
+} // namespace primal::utils::math
+
+#endif // PRIMAL_PRIME_COUNT_BOUND_HPP
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file prime-search.hpp
+ * @brief Defines function templates that find the primes nearest to a number.
+ */
+
+#ifndef PRIMAL_PRIME_SEARCH_HPP
+#define PRIMAL_PRIME_SEARCH_HPP
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "primal/utils/math/primality-test.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/uint128.hpp"
+
+namespace primal::utils::math {
+
+/**
+ * Largest number whose primality the window primes settle on their own.
+ */
+inline constexpr uint64_t windowCeiling = uint64_t{1} << 24;
+
+/**
+ * Gets the odd primes used to pre-sieve search windows.
+ * @details Primes up to 2^12 remove about 86% of the odd numbers in a window,
+ * while setting up the crossing-off for all of them takes only a few
+ * microseconds.
+ * @return Odd primes up to the square root of windowCeiling
+ */
+inline const std::vector<uint32_t>& windowPrimes() {
+    static const std::vector<uint32_t> primes = basePrimes(windowCeiling);
+    return primes;
+}
+
+/**
+ * Calculates the width of the first window searched for primes.
+ * @details Wide enough to hold the requested number of primes on average
+ * (twice the expected gap, ln(number), per prime), and capped at a segment so
+ * that memory stays bounded.
+ * @tparam T Unsigned integer type
+ * @param number Number the search starts from
+ * @param count Number of primes wanted
+ * @return Window width
+ */
+template <typename T>
+requires UnsignedInteger<T>
+uint64_t windowWidth(T number, uint64_t count) {
+    uint64_t gap = static_cast<uint64_t>(bitWidth(number)) * 7 / 10 + 1;
+    return std::clamp<uint64_t>(2 * count * gap, 128, segmentSpan);
+}
+
+/**
+ * Checks whether a survivor of the window sieve is a prime.
+ * @tparam T Unsigned integer type
+ * @param candidate Number without a factor among the window primes
+ * @return True if prime, false otherwise
+ */
+template <typename T>
+requires UnsignedInteger<T>
+bool confirm(T candidate) {
+    return candidate < windowCeiling ||
+           primalityTest(candidate) == Primality::PRIME;
+}
+
+/**
+ * Finds the primes immediately above a number.
+ * @details Sieves a window past the number with the window primes, confirms
+ * the survivors with the Miller-Rabin or Baillie-PSW test and moves on to a
+ * window twice as wide until enough primes are found.
+ * @tparam T Unsigned integer type
+ * @param number Number to search above
+ * @param count Number of primes wanted
+ * @return Up to count primes above the number in ascending order, fewer if
+ * the type runs out of room
+ */
+template <typename T>
+requires UnsignedInteger<T>
+std::vector<T> nextPrimes(T number, uint64_t count) {
+    constexpr T largest = std::numeric_limits<T>::max();
+    std::vector<T> found;
+    Segment<T> segment;
+    uint64_t width = windowWidth(number, count);
+
+    for (T low = number; found.size() < count && low != largest;) {
+        T start = static_cast<T>(low + 1) & ~T{1};
+        T end = largest - start < width ? largest
+                                        : static_cast<T>(start + width - 1);
+        segment.sieve(start, end, windowPrimes());
+        segment.forEachPrime([&](T candidate) {
+            if (candidate > number && found.size() < count &&
+                confirm(candidate)) {
+                found.push_back(candidate);
+            }
+        });
+        low = end;
+        width = std::min<uint64_t>(2 * width, segmentSpan);
+    }
+    return found;
+}
+
+/**
+ * Finds the primes immediately below a number.
+ * @details Works like nextPrimes(), moving down from the number instead.
+ * @tparam T Unsigned integer type
+ * @param number Number to search below
+ * @param count Number of primes wanted
+ * @return Up to count primes below the number in descending order, fewer if
+ * there are not enough
+ */
+template <typename T>
+requires UnsignedInteger<T>
+std::vector<T> previousPrimes(T number, uint64_t count) {
+    std::vector<T> found, window;
+    Segment<T> segment;
+    uint64_t width = windowWidth(number, count);
+
+    for (T high = number; found.size() < count && high > 0;) {
+        T end = high - 1;
+        T start = static_cast<T>(end < width ? 0 : end - width + 1) & ~T{1};
+        segment.sieve(start, end, windowPrimes());
+
+        // Collect the survivors, then confirm them from the top down.
+        window.clear();
+        segment.forEachPrime([&](T candidate) { window.push_back(candidate); });
+        for (auto it = window.rbegin();
+             it != window.rend() && found.size() < count; it++) {
+            if (confirm(*it)) found.push_back(*it);
+        }
+        high = start;
+        width = std::min<uint64_t>(2 * width, segmentSpan);
+    }
+    return found;
+}
+
+} // namespace primal::utils::math
+
+#endif // PRIMAL_PRIME_SEARCH_HPP
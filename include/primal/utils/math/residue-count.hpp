@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file residue-count.hpp
+ * @brief Defines a counter of the primes of a sieved segment in every residue
+ * class modulo a fixed number.
+ */
+
+#ifndef PRIMAL_RESIDUE_COUNT_HPP
+#define PRIMAL_RESIDUE_COUNT_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "primal/utils/math/kernels.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/uint128.hpp"
+
+namespace primal::utils::math {
+
+/**
+ * Largest modulus accepted by the residue counter.
+ */
+inline constexpr uint32_t maxModulus = uint32_t{1} << 20;
+
+/**
+ * Largest number of classes counted with masks rather than per prime.
+ * @details Masking costs one AND and popcount per class for every word of the
+ * bitmap, while extracting costs one reduction for each of the few primes in
+ * a word, so masks only pay off while the classes are few.
+ */
+inline constexpr std::size_t maskedClassLimit = 32;
+
+/**
+ * Counts the odd primes of sieved segments in the residue classes a mod q with
+ * gcd(a, q) = 1.
+ * @details Bit j of a bitmap word stands for a number whose residue is
+ * (r + 2j) mod q, where r is the residue of the word's first number. With few
+ * classes, one mask per class and per r is built up front and every word is
+ * counted with an AND and a popcount per class, without looking at single
+ * primes. Otherwise every prime is extracted and reduced with a precomputed
+ * reciprocal of q. The classes that share a factor with q hold at most the
+ * prime factor itself, and 2 is not in the bitmap at all; callers account for
+ * those primes separately.
+ */
+class ResidueCounter {
+public:
+    /**
+     * Prepare the counter for a modulus.
+     * @param modulus Modulus q (from 1 up to maxModulus)
+     */
+    explicit ResidueCounter(uint32_t modulus)
+        : modulus_(modulus), reciprocal(UINT64_MAX / modulus + 1),
+          index_(modulus, -1) {
+        for (uint32_t a = 0; a < modulus; a++) {
+            if (std::gcd(a, modulus) != 1) continue;
+            index_[a] = static_cast<int32_t>(classes_.size());
+            classes_.push_back(a);
+        }
+        if (!masked()) return;
+
+        // Row r holds the mask of every class for words starting at residue r.
+        masks.assign(std::size_t{modulus} * classes_.size(), 0);
+        for (uint32_t r = 0; r < modulus; r++) {
+            for (uint32_t j = 0; j < 64; j++) {
+                int32_t c = index_[(r + 2 * uint64_t{j}) % modulus];
+                if (c >= 0) masks[r * classes_.size() + c] |= uint64_t{1} << j;
+            }
+        }
+    }
+
+    /**
+     * Add the primes of a sieved segment to the counters of their classes.
+     * @tparam T Unsigned integer type
+     * @param segment Sieved segment
+     * @param counts One counter per class of classes()
+     */
+    template <typename T>
+    requires std::is_unsigned_v<T>
+    void add(const Segment<T>& segment, uint64_t* counts) const {
+        const auto& words = segment.bitmap();
+        const auto first =
+            static_cast<uint32_t>((segment.low() + 1) % modulus_);
+        if (masked()) {
+            kernels::maskedPopcount(words.data(), words.size(), masks.data(),
+                                    classes_.size(), modulus_, first,
+                                    128 % modulus_, counts);
+            return;
+        }
+
+        thread_local std::vector<uint32_t> indices;
+        indices.resize(words.size() * 64);
+        std::size_t found =
+            kernels::extractBits(words.data(), words.size(), indices.data());
+        for (std::size_t i = 0; i < found; i++) {
+            int32_t c = index_[reduce(first + 2 * uint64_t{indices[i]})];
+            if (c >= 0) counts[c]++;
+        }
+    }
+
+    /**
+     * Residues coprime to the modulus in ascending order, which are the
+     * classes counted by add().
+     */
+    const std::vector<uint32_t>& classes() const { return classes_; }
+
+    /**
+     * Position of a residue in classes(), or -1 if it shares a factor with
+     * the modulus.
+     */
+    int32_t index(uint32_t residue) const { return index_[residue]; }
+
+    /**
+     * Modulus of the classes.
+     */
+    uint32_t modulus() const { return modulus_; }
+
+    /**
+     * Whether segments are counted with masks.
+     */
+    bool masked() const { return classes_.size() <= maskedClassLimit; }
+
+    /**
+     * Amount of memory held by the counter in bytes.
+     */
+    std::size_t bytes() const {
+        return masks.size() * sizeof(uint64_t) +
+               index_.size() * sizeof(int32_t) +
+               classes_.size() * sizeof(uint32_t);
+    }
+
+private:
+    /**
+     * Reduce a number below 2^32 modulo the modulus without dividing.
+     * @param number Number to reduce
+     * @return Number mod modulus
+     */
+    uint32_t reduce(uint64_t number) const {
+        uint64_t low = reciprocal * number;
+        return static_cast<uint32_t>(
+            (static_cast<uint128_t>(low) * modulus_) >> 64);
+    }
+
+    /**
+     * Modulus of the classes.
+     */
+    uint32_t modulus_;
+
+    /**
+     * Ceiling of 2^64 divided by the modulus.
+     */
+    uint64_t reciprocal;
+
+    /**
+     * Position of every residue in classes_, or -1.
+     */
+    std::vector<int32_t> index_;
+
+    /**
+     * Residues coprime to the modulus.
+     */
+    std::vector<uint32_t> classes_;
+
+    /**
+     * Mask of every class for every residue of a word's first number.
+     */
+    std::vector<uint64_t> masks;
+};
+
+} // namespace primal::utils::math
+
+#endif // PRIMAL_RESIDUE_COUNT_HPP
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file safe-prime-sieve.hpp
+ * @brief Defines a segmented sieve that finds Sophie Germain primes q, for
+ * which the safe prime 2q + 1 is also prime.
+ */
+
+#ifndef PRIMAL_SAFE_PRIME_SIEVE_HPP
+#define PRIMAL_SAFE_PRIME_SIEVE_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "primal/utils/math/kernels.hpp"
+#include "primal/utils/math/primality-test.hpp"
+#include "primal/utils/trace.hpp"
+
+namespace primal::utils::math {
+
+/**
+ * Largest prime used to sieve safe prime candidates.
+ * @details Past this point, crossing off removes fewer candidates per
+ * microsecond than the Miller-Rabin tests of the survivors cost.
+ */
+inline constexpr uint32_t safeSieveLimit = uint32_t{1} << 16;
+
+/**
+ * A block of odd candidates q for which q and 2q + 1 are sieved together.
+ * @details Bit i of the bitmap corresponds to q = low + 2i + 1. A small prime r
+ * rules out q = 0 (mod r) because r divides q, and q = (r - 1) / 2 (mod r)
+ * because r divides 2q + 1. Both starting bits come from the same residue of
+ * the segment start, so each prime costs one division for two crossings-off.
+ * Joint survivors are confirmed with the Miller-Rabin test unless the sieving
+ * primes already cover the square root of 2q + 1.
+ * @tparam T Unsigned integer type of at most 64 bits
+ */
+template <typename T>
+requires std::is_unsigned_v<T> && (sizeof(T) <= sizeof(uint64_t))
+class SafePrimeSegment {
+public:
+    /**
+     * Sieve the candidates q in the range [low, high].
+     * @param low Smallest candidate (must be even)
+     * @param high Largest candidate, with 2 * high + 1 fitting in T
+     * @param primes Odd sieving primes in ascending order
+     */
+    void sieve(T low, T high, const std::vector<uint32_t>& primes) {
+        trace::Span span("safe sieve", "low", static_cast<uint64_t>(low));
+        low_ = low;
+        bits_ = static_cast<std::size_t>((high - low + 1) / 2);
+        words_.resize((bits_ + 63) / 64);
+        kernels::fillBits(words_.data(), bits_);
+
+        // Rule out q = 1, which is not prime.
+        if (low == 0 && bits_) words_[0] &= ~uint64_t{1};
+
+        largest_ = 0;
+        for (uint32_t prime : primes) {
+            // Bit of q = a (mod prime) is (a - low - 1) / 2 mod prime.
+            uint64_t half = (prime + 1) / 2;
+            uint64_t shift = (low + 1) % prime;
+            auto start = [&](uint64_t residue) {
+                return static_cast<std::size_t>(
+                    (residue + prime - shift) % prime * half % prime);
+            };
+
+            // Keep the prime itself as q, and q = (prime - 1) / 2 as 2q + 1.
+            std::size_t divisor = start(0);
+            if (low + 2 * T(divisor) + 1 == prime) divisor += prime;
+            std::size_t safe = start(prime / 2);
+            if (low + 2 * T(safe) + 1 == prime / 2) safe += prime;
+
+            kernels::crossOff(words_.data(), bits_, divisor, prime);
+            kernels::crossOff(words_.data(), bits_, safe, prime);
+            largest_ = prime;
+        }
+    }
+
+    /**
+     * Call a function on every Sophie Germain prime in the segment in
+     * ascending order.
+     * @tparam F Callable taking a Sophie Germain prime q of type T
+     * @param f Function to call
+     * @return Number of survivors of the sieve
+     */
+    template <typename F>
+    std::size_t forEachPrime(F&& f) const {
+        thread_local std::vector<uint32_t> indices;
+        indices.resize(bits_);
+        std::size_t found =
+            kernels::extractBits(words_.data(), words_.size(), indices.data());
+
+        // The sieve alone settles candidates below the square of its primes.
+        const uint64_t proven = uint64_t{largest_} * largest_;
+        for (std::size_t i = 0; i < found; i++) {
+            T q = static_cast<T>(low_ + 2 * T{indices[i]} + 1);
+            T p = static_cast<T>(2 * q + 1);
+            if (p >= proven && (millerRabinTest(q) != Primality::PRIME ||
+                                millerRabinTest(p) != Primality::PRIME)) {
+                continue;
+            }
+            f(q);
+        }
+        return found;
+    }
+
+private:
+    /**
+     * Smallest number in the segment.
+     */
+    T low_ = 0;
+
+    /**
+     * Number of odd candidates represented in the bitmap.
+     */
+    std::size_t bits_ = 0;
+
+    /**
+     * Largest prime the segment was sieved with.
+     */
+    uint32_t largest_ = 0;
+
+    /**
+     * Bitmap of odd candidates, where a set bit marks a joint survivor.
+     */
+    std::vector<uint64_t> words_;
+};
+
+} // namespace primal::utils::math
+
+#endif // PRIMAL_SAFE_PRIME_SIEVE_HPP
@@ -0,0 +1,368 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file segmented-sieve.hpp
+ * @brief Defines a segmented Sieve of Eratosthenes that works on one
+ * cache-sized block of odd numbers at a time.
+ */
+
+#ifndef PRIMAL_SEGMENTED_SIEVE_HPP
+#define PRIMAL_SEGMENTED_SIEVE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "primal/utils/math/kernels.hpp"
+#include "primal/utils/math/prime-count-bound.hpp"
+#include "primal/utils/math/sieve.hpp"
+#include "primal/utils/trace.hpp"
+#include "primal/utils/uint128.hpp"
+
+namespace primal::utils::math {
+
+/**
+ * Amount of numbers covered by a single sieve segment.
+ * @details Only odd numbers are stored, so a segment occupies half this many
+ * bits (32 KiB), which fits in the L1 data cache of most processors.
+ */
+inline constexpr uint64_t segmentSpan = uint64_t{1} << 19;
+
+/**
+ * Calculates the integer square root of a number.
+ * @tparam T Unsigned integer type
+ * @param number Number to take the square root of
+ * @return Largest integer whose square does not exceed the number
+ */
+template <typename T>
+requires UnsignedInteger<T>
+T isqrt(T number) {
+    T root = static_cast<T>(std::sqrt(static_cast<long double>(number)));
+
+    // Correct the floating point estimate in either direction.
+    while (root > 0 && root > number / root) root--;
+    while ((root + 1) <= number / (root + 1)) root++;
+    return root;
+}
+
+/**
+ * A block of consecutive numbers sieved using a set of base primes.
+ * @details Only odd numbers are represented. Bit i of the bitmap corresponds to
+ * the number low + 2i + 1, and a set bit means that the number is prime. The
+ * even prime 2 is not part of the bitmap and is reported separately.
+ * @tparam T Unsigned integer type
+ */
+template <typename T>
+requires UnsignedInteger<T>
+class Segment {
+public:
+    /**
+     * Sieve the numbers in the range [low, high].
+     * @param low Smallest number in the segment (must be even)
+     * @param high Largest number in the segment
+     * @param primes Odd base primes covering at least the square root of high
+     */
+    void sieve(T low, T high, const std::vector<uint32_t>& primes) {
+        trace::Span span("sieve", "low", static_cast<uint64_t>(low));
+        low_ = low;
+        high_ = high;
+        bits_ = static_cast<std::size_t>((high - low + 1) / 2);
+
+        // Mark every odd number as prime, leaving the padding bits cleared.
+        words_.resize((bits_ + 63) / 64);
+        kernels::fillBits(words_.data(), bits_);
+
+        // Rule out 1 (it is neither prime nor composite).
+        if (low == 0 && bits_) words_[0] &= ~uint64_t{1};
+
+        // Rule out odd multiples of the base primes.
+        for (uint32_t prime : primes) {
+            uint64_t square = uint64_t{prime} * prime;
+            if (square > high) break;
+
+            // Bit index of the first odd multiple to rule out.
+            std::size_t j;
+            if (square >= low) {
+                j = static_cast<std::size_t>((square - low - 1) / 2);
+            } else {
+                uint64_t offset = (prime - (low + 1) % prime) % prime;
+                j = static_cast<std::size_t>(offset * ((prime + 1) / 2) %
+                                             prime);
+            }
+
+            kernels::crossOff(words_.data(), bits_, j, prime);
+        }
+    }
+
+    /**
+     * Count the primes in the segment, including 2 if it is covered.
+     * @return Number of primes found
+     */
+    uint64_t count() const {
+        uint64_t total = containsTwo() ? 1 : 0;
+        return total + kernels::popcount(words_.data(), words_.size());
+    }
+
+    /**
+     * Call a function on every prime in the segment in ascending order.
+     * @tparam F Callable taking a prime of type T
+     * @param f Function to call
+     */
+    template <typename F>
+    void forEachPrime(F&& f) const {
+        if (containsTwo()) f(T{2});
+
+        // Collect the set bits first so the scan runs in a tight loop.
+        thread_local std::vector<uint32_t> indices;
+        indices.resize(bits_);
+        std::size_t found =
+            kernels::extractBits(words_.data(), words_.size(), indices.data());
+        for (std::size_t i = 0; i < found; i++) {
+            f(static_cast<T>(low_ + 2 * T{indices[i]} + 1));
+        }
+    }
+
+    /**
+     * Check whether a number in the segment is prime.
+     * @param number Number in the range [low, high]
+     * @return True if prime, false otherwise
+     */
+    bool contains(T number) const {
+        if (number == 2) return true;
+        if (number % 2 == 0) return false;
+        auto bit = static_cast<std::size_t>((number - low_ - 1) / 2);
+        return (words_[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    /**
+     * Find the prime with a particular index within the segment.
+     * @param index One-based index, at most count()
+     * @return Prime with the index
+     */
+    T nth(uint64_t index) const {
+        if (containsTwo() && index-- == 1) return 2;
+        for (std::size_t i = 0; i < words_.size(); i++) {
+            auto ones = static_cast<uint64_t>(std::popcount(words_[i]));
+            if (index > ones) {
+                index -= ones;
+                continue;
+            }
+
+            // Drop the lower set bits of the word that holds the prime.
+            uint64_t word = words_[i];
+            while (--index) word &= word - 1;
+            std::size_t bit = i * 64 + std::countr_zero(word);
+            return static_cast<T>(low_ + 2 * T(bit) + 1);
+        }
+        return 0;
+    }
+
+    /**
+     * Bitmap of the odd numbers in the segment, where a set bit marks a prime.
+     */
+    const std::vector<uint64_t>& bitmap() const { return words_; }
+
+    /**
+     * Smallest number in the segment.
+     */
+    T low() const { return low_; }
+
+    /**
+     * Largest number in the segment.
+     */
+    T high() const { return high_; }
+
+private:
+    /**
+     * Check whether the even prime 2 lies inside the segment.
+     * @return True if 2 is covered, false otherwise
+     */
+    bool containsTwo() const { return low_ <= 2 && high_ >= 2; }
+
+    /**
+     * Smallest number in the segment.
+     */
+    T low_ = 0;
+
+    /**
+     * Largest number in the segment.
+     */
+    T high_ = 0;
+
+    /**
+     * Number of odd numbers represented in the bitmap.
+     */
+    std::size_t bits_ = 0;
+
+    /**
+     * Bitmap of odd numbers, where a set bit marks a prime.
+     */
+    std::vector<uint64_t> words_;
+};
+
+/**
+ * Calculates an upper bound for the number of base primes needed to sieve
+ * every number up to a ceiling.
+ * @tparam T Unsigned integer type
+ * @param ceiling Largest number that will be sieved
+ * @return Upper bound for the size of basePrimes(ceiling)
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+std::size_t basePrimeCount(T ceiling) {
+    return primeCountUpperBound(isqrt(ceiling));
+}
+
+/**
+ * Calculates an upper bound for the number of primes in any one segment.
+ * @details Uses the Brun-Titchmarsh bound of Montgomery and Vaughan,
+ * pi(x + y) - pi(x) < 2y / ln(y).
+ */
+inline const std::size_t segmentPrimeCount = static_cast<std::size_t>(
+    2 * static_cast<double>(segmentSpan) /
+    std::log(static_cast<double>(segmentSpan))) + 1;
+
+/**
+ * Finds the odd primes that are needed to sieve every number up to a ceiling.
+ * @details Every odd prime up to the square root of the ceiling is returned.
+ * Large limits are sieved one segment at a time to keep memory bounded.
+ * @tparam T Unsigned integer type
+ * @param ceiling Largest number that will be sieved
+ * @return Odd sieving primes in ascending order
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+std::vector<uint32_t> basePrimes(T ceiling) {
+    auto limit = static_cast<uint64_t>(isqrt(ceiling));
+
+    // Sieve the primes up to the square root of the limit directly.
+    std::vector<uint64_t> small;
+    sieve(isqrt(limit), small);
+    std::vector<uint32_t> sieving;
+    for (uint64_t prime : small) {
+        if (prime != 2) sieving.push_back(static_cast<uint32_t>(prime));
+    }
+
+    // Sieve the base primes themselves segment by segment.
+    std::vector<uint32_t> primes;
+    primes.reserve(basePrimeCount(ceiling));
+    Segment<uint64_t> segment;
+    for (uint64_t low = 0; low <= limit; low += segmentSpan) {
+        uint64_t high = std::min(limit, low + segmentSpan - 1);
+        segment.sieve(low, high, sieving);
+        segment.forEachPrime([&](uint64_t prime) {
+            if (prime != 2) primes.push_back(static_cast<uint32_t>(prime));
+        });
+    }
+    return primes;
+}
+
+/**
+ * Calculates the number of segments needed to cover every number up to a
+ * ceiling.
+ * @tparam T Unsigned integer type
+ * @param ceiling Largest number to cover
+ * @return Number of segments
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+uint64_t segmentCount(T ceiling) {
+    return static_cast<uint64_t>(ceiling / segmentSpan) + 1;
+}
+
+/**
+ * Calculates the range of numbers covered by a particular segment.
+ * @tparam T Unsigned integer type
+ * @param index Zero-based segment index
+ * @param ceiling Largest number covered by any segment
+ * @param low Smallest number in the segment
+ * @param high Largest number in the segment
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+void segmentBounds(uint64_t index, T ceiling, T& low, T& high) {
+    low = static_cast<T>(index * segmentSpan);
+    high = (ceiling - low < segmentSpan)
+               ? ceiling
+               : static_cast<T>(low + segmentSpan - 1);
+}
+
+/**
+ * Counts the primes in a range by sieving it one segment at a time.
+ * @tparam T Unsigned integer type
+ * @param low Smallest number in the range
+ * @param high Largest number in the range
+ * @param primes Odd base primes covering at least the square root of high
+ * @return Number of primes in [low, high]
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+uint64_t countPrimes(T low, T high, const std::vector<uint32_t>& primes) {
+    if (low > high) return 0;
+
+    uint64_t total = 0;
+    Segment<T> segment;
+    for (T start = low & ~T{1};; start += segmentSpan) {
+        T end = high - start < segmentSpan
+                    ? high
+                    : static_cast<T>(start + segmentSpan - 1);
+        segment.sieve(start, end, primes);
+        total += segment.count();
+        if (end == high) break;
+    }
+
+    // Segments start at an even number, which only adds a prime if it is 2.
+    return low == 3 ? total - 1 : total;
+}
+
+/**
+ * Finds the prime with a particular index counting from an even number.
+ * @tparam T Unsigned integer type
+ * @param low Even number to start counting from
+ * @param index One-based index among the primes from low onwards
+ * @param primes Odd base primes covering the square root of the prime found
+ * @return Prime with the index, or 0 if it does not fit in T
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+T nthPrime(T low, uint64_t index, const std::vector<uint32_t>& primes) {
+    constexpr T largest = std::numeric_limits<T>::max();
+    Segment<T> segment;
+    for (T start = low;; start += segmentSpan) {
+        T end = largest - start < segmentSpan
+                    ? largest
+                    : static_cast<T>(start + segmentSpan - 1);
+        segment.sieve(start, end, primes);
+        uint64_t found = segment.count();
+        if (index <= found) return segment.nth(index);
+        if (end == largest) return 0;
+        index -= found;
+    }
+}
+
+} // namespace primal::utils::math
+
+#endif // PRIMAL_SEGMENTED_SIEVE_HPP
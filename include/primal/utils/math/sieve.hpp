@@ -23,6 +23,8 @@
 #include <type_traits>
 #include <vector>
 
+#include "primal/utils/math/prime-count-bound.hpp"
+
 /**
  * @author Emma Casey
  * @date 2024-06-14
@@ -36,12 +38,13 @@ namespace primal::utils::math {
 /**
  * Find all prime numbers below a given ceiling using a Sieve of Eratosthenes.
  * @tparam T Unsigned integer type
+ * @tparam Primes Container of T with reserve() and push_back()
  * @param ceiling Largest number to check
- * @param primes Vector of primes found
+ * @param primes Container of primes found
  */
-template <typename T>
+template <typename T, typename Primes>
 requires std::is_unsigned_v<T>
-void sieve(T ceiling, std::vector<T>& primes) {
+void sieve(T ceiling, Primes& primes) {
     // Offset the ceiling by 1 to compensate for zero-based indexing.
     ceiling++;
 
@@ -61,7 +64,7 @@ void sieve(T ceiling, std::vector<T>& primes) {
 
     // Rule out multiples of primes.
     // Only check odds because evens have already been ruled out.
-    for (T i = 3; i * i < ceiling; i += 2) {
+    for (T i = 3; i <= (ceiling - 1) / i; i += 2) {
         // Skip non-prime numbers.
         if (!isPrime[i]) continue;
 
@@ -71,7 +74,10 @@ void sieve(T ceiling, std::vector<T>& primes) {
         }
     }
 
-    // Fill the primes vector with the remaining numbers.
+    // Reserve room for every prime up front to avoid reallocating.
+    primes.reserve(primes.size() + primeCountUpperBound(ceiling));
+
+    // Fill the primes container with the remaining numbers.
     primes.push_back(2);
     for (T i = 3; i < isPrime.size(); i += 2) {
         if (isPrime[i]) primes.push_back(i);
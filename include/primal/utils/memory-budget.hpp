@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file memory-budget.hpp
+ * @brief Defines a budget that sizes allocations to fit a memory limit.
+ */
+
+#ifndef PRIMAL_MEMORY_BUDGET_HPP
+#define PRIMAL_MEMORY_BUDGET_HPP
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "primal/utils/io/open-output.hpp"
+#include "primal/utils/ordered-pipeline.hpp"
+#include "primal/utils/trace.hpp"
+
+namespace primal::utils {
+
+/**
+ * Number of worker threads and output buffers of an ordered pipeline.
+ */
+struct PipelineSize {
+    /**
+     * Number of worker threads.
+     */
+    unsigned workers;
+
+    /**
+     * Number of output buffers.
+     */
+    std::size_t slots;
+};
+
+/**
+ * Keeps track of the memory a function plans to use against a limit.
+ * @details Every large allocation is reserved before it is made, so a budget
+ * that is too small fails with an error naming the allocation instead of
+ * swapping or being killed halfway through. Memory already in use by the
+ * process when the budget is created counts against it. An unlimited budget
+ * never fails and leaves every size at its default.
+ */
+class MemoryBudget {
+public:
+    /**
+     * Start a budget.
+     * @param limit Largest number of bytes to use, or 0 for no limit
+     */
+    explicit MemoryBudget(uint64_t limit = 0)
+        : limit(limit), used(limit ? resident() : 0) {
+        if (limit && used > limit) fail("the program itself", used);
+    }
+
+    /**
+     * Reserve memory for an allocation.
+     * @param bytes Size of the allocation
+     * @param what Description of the allocation for the error message
+     */
+    void reserve(uint64_t bytes, const std::string& what) {
+        if (limit && bytes > limit - used) fail(what, bytes);
+        used += bytes;
+    }
+
+    /**
+     * Reserve memory for buffering output.
+     * @return Largest number of bytes the output sink may buffer
+     */
+    uint64_t outputBuffer() {
+        uint64_t bytes = io::defaultOutputBuffer;
+        if (limit) {
+            bytes = std::clamp<uint64_t>((limit - used) / 4, minimumBuffer,
+                                         io::defaultOutputBuffer);
+        }
+        reserve(bytes, "the output buffer");
+        return bytes;
+    }
+
+    /**
+     * Choose the number of workers and output buffers of a pipeline and
+     * reserve their memory.
+     * @details Spare output buffers are given up before workers are. While
+     * tracing, every worker also holds the ring of its events.
+     * @param perWorker Memory used by each worker thread
+     * @param perSlot Memory used by each output buffer
+     * @return Pipeline size that fits the budget
+     */
+    PipelineSize pipeline(uint64_t perWorker, uint64_t perSlot) {
+        PipelineSize size{threadCount(), 2 * std::size_t{threadCount()}};
+        if (trace::active()) perWorker += trace::ringBytes;
+        auto cost = [&] { return size.workers * perWorker +
+                                 size.slots * perSlot; };
+        if (limit) {
+            while (size.slots > size.workers && cost() > limit - used) {
+                size.slots--;
+            }
+            while (size.workers > 1 && cost() > limit - used) {
+                size.slots = --size.workers;
+            }
+        }
+        reserve(cost(), "the worker buffers");
+        return size;
+    }
+
+    /**
+     * Largest amount of memory the process has used so far.
+     * @return Peak resident set size in bytes
+     */
+    static uint64_t peak() {
+        rusage usage{};
+        ::getrusage(RUSAGE_SELF, &usage);
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+    }
+
+private:
+    /**
+     * Smallest output buffer worth using.
+     */
+    static constexpr uint64_t minimumBuffer = uint64_t{1} << 20;
+
+    /**
+     * Memory currently used by the process.
+     * @return Resident set size in bytes, or 0 if it cannot be determined
+     */
+    static uint64_t resident() {
+        std::ifstream statm("/proc/self/statm");
+        uint64_t pages = 0, residentPages = 0;
+        if (!(statm >> pages >> residentPages)) return 0;
+        return residentPages * static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    }
+
+    /**
+     * Report that an allocation does not fit.
+     * @param what Description of the allocation
+     * @param bytes Size of the allocation
+     */
+    [[noreturn]] void fail(const std::string& what, uint64_t bytes) const {
+        throw std::runtime_error(
+            "Memory budget of " + std::to_string(limit) + " bytes exceeded: " +
+            std::to_string(bytes) + " bytes are needed for " + what +
+            " but only " + std::to_string(used < limit ? limit - used : 0) +
+            " are left.");
+    }
+
+    uint64_t limit;
+    uint64_t used;
+};
+
+} // namespace primal::utils
+
+#endif // PRIMAL_MEMORY_BUDGET_HPP
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file ordered-pipeline.hpp
+ * @brief Defines helpers that let worker threads produce output in parallel
+ * while a single writer emits it in task order.
+ */
+
+#ifndef PRIMAL_ORDERED_PIPELINE_HPP
+#define PRIMAL_ORDERED_PIPELINE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "primal/utils/trace.hpp"
+
+namespace primal::utils {
+
+/**
+ * Gets the number of worker threads to use for parallel work.
+ * @return Number of hardware threads, or 1 if it cannot be determined
+ */
+inline unsigned threadCount() {
+    return std::max(1U, std::thread::hardware_concurrency());
+}
+
+/**
+ * Computes an exclusive prefix sum over values published out of order.
+ * @details Workers publish the value of their task as soon as it is known and
+ * may then wait for the sum of every value belonging to an earlier task. Only
+ * values that have not been folded or read yet are kept in memory.
+ */
+class PrefixSum {
+public:
+    /**
+     * Publish the value belonging to a task.
+     * @param task Zero-based task index
+     * @param value Value of the task
+     */
+    void publish(std::size_t task, uint64_t value) {
+        std::lock_guard lock(mutex);
+        pending[task] = value;
+
+        // Fold every consecutive published value into the running sum.
+        bool advanced = false;
+        for (auto it = pending.begin();
+             it != pending.end() && it->first == known;
+             it = pending.erase(it)) {
+            sums[known++] = total;
+            total += it->second;
+            advanced = true;
+        }
+        if (advanced) changed.notify_all();
+    }
+
+    /**
+     * Wait for the sum of every value belonging to an earlier task.
+     * @details Each task may only ask for its sum once.
+     * @param task Zero-based task index
+     * @return Sum of the values of tasks [0, task)
+     */
+    uint64_t before(std::size_t task) {
+        std::unique_lock lock(mutex);
+        changed.wait(lock, [&] { return known >= task; });
+        auto it = sums.find(task);
+        if (it == sums.end()) return total;
+        uint64_t sum = it->second;
+        sums.erase(it);
+        return sum;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::map<std::size_t, uint64_t> pending;
+    std::map<std::size_t, uint64_t> sums;
+    std::size_t known = 0;
+    uint64_t total = 0;
+};
+
+/**
+ * Output of a task together with the number of items (such as primes) in it.
+ */
+struct Chunk {
+    /**
+     * Rendered output text.
+     */
+    std::string text;
+
+    /**
+     * Number of items found by the task.
+     */
+    uint64_t count = 0;
+
+    /**
+     * Empty the chunk while keeping the text's memory for reuse.
+     */
+    void clear() {
+        text.clear();
+        count = 0;
+    }
+};
+
+/**
+ * Runs tasks on worker threads and hands their output buffers to the calling
+ * thread strictly in task order.
+ * @details Only a fixed window of tasks beyond the one being written may hold a
+ * buffer, so memory stays bounded when the writer is slow. Buffers are reused
+ * across tasks to avoid repeated allocations.
+ * @tparam Slot Type of the per-task output buffer
+ */
+template <typename Slot = Chunk>
+class OrderedPipeline {
+public:
+    /**
+     * Prepare a pipeline.
+     * @param tasks Number of tasks to run
+     * @param workers Number of worker threads
+     * @param slots Number of output buffers (at least one per worker)
+     */
+    OrderedPipeline(std::size_t tasks, unsigned workers, std::size_t slots)
+        : tasks(tasks), workers(std::max(1U, workers)),
+          buffers(std::max<std::size_t>(slots, this->workers)),
+          filled(buffers.size(), false) {}
+
+    /**
+     * Run the pipeline until every task has been written.
+     * @tparam Produce Callable taking (task, buffer) that fills the buffer
+     * @tparam Consume Callable taking (task, buffer) that writes the buffer
+     * @param produce Function called on worker threads
+     * @param consume Function called on the calling thread in task order
+     */
+    template <typename Produce, typename Consume>
+    void run(Produce&& produce, Consume&& consume) {
+        std::vector<std::jthread> threads;
+        for (unsigned i = 0; i < workers; i++) {
+            threads.emplace_back([&] { work(produce); });
+        }
+
+        try {
+            for (std::size_t task = 0; task < tasks; task++) {
+                Slot& buffer = awaitFilled(task);
+                {
+                    trace::Span span("consume", "task", task);
+                    consume(task, buffer);
+                }
+                recycle(task);
+            }
+        } catch (...) {
+            abort(std::current_exception());
+        }
+
+        threads.clear();
+        if (error) std::rethrow_exception(error);
+    }
+
+private:
+    /**
+     * Worker thread loop that claims tasks in order and fills their buffers.
+     * @tparam Produce Callable taking (task, buffer) that fills the buffer
+     * @param produce Function to run for each task
+     */
+    template <typename Produce>
+    void work(Produce& produce) {
+        trace::nameThread("worker");
+        try {
+            for (std::size_t task = next++; task < tasks; task = next++) {
+                Slot* buffer = awaitSlot(task);
+                if (!buffer) return;
+                if constexpr (requires { buffer->clear(); }) {
+                    buffer->clear();
+                } else {
+                    *buffer = Slot{};
+                }
+                {
+                    trace::Span span("produce", "task", task);
+                    produce(task, *buffer);
+                }
+                markFilled(task);
+            }
+        } catch (...) {
+            abort(std::current_exception());
+        }
+    }
+
+    /**
+     * Wait until a task falls inside the window of buffered tasks.
+     * @param task Zero-based task index
+     * @return Buffer reserved for the task, or nullptr if the run was aborted
+     */
+    Slot* awaitSlot(std::size_t task) {
+        trace::Span span("wait for slot", "task", task);
+        std::unique_lock lock(mutex);
+        changed.wait(lock, [&] {
+            return error || task < written + buffers.size();
+        });
+        return error ? nullptr : &buffers[task % buffers.size()];
+    }
+
+    /**
+     * Mark the buffer of a task as ready to be written.
+     * @param task Zero-based task index
+     */
+    void markFilled(std::size_t task) {
+        std::lock_guard lock(mutex);
+        filled[task % buffers.size()] = true;
+        changed.notify_all();
+    }
+
+    /**
+     * Wait until the buffer of a task is ready to be written.
+     * @param task Zero-based task index
+     * @return Buffer holding the output of the task
+     */
+    Slot& awaitFilled(std::size_t task) {
+        trace::Span span("wait for task", "task", task);
+        std::unique_lock lock(mutex);
+        changed.wait(lock,
+                     [&] { return error || filled[task % buffers.size()]; });
+        if (error) std::rethrow_exception(error);
+        return buffers[task % buffers.size()];
+    }
+
+    /**
+     * Release the buffer of a written task so that a later task can use it.
+     * @param task Zero-based task index
+     */
+    void recycle(std::size_t task) {
+        std::lock_guard lock(mutex);
+        filled[task % buffers.size()] = false;
+        written = task + 1;
+        changed.notify_all();
+    }
+
+    /**
+     * Stop every thread after a failure and remember the first error.
+     * @param exception Error that caused the failure
+     */
+    void abort(std::exception_ptr exception) {
+        std::lock_guard lock(mutex);
+        if (!error) error = exception;
+        changed.notify_all();
+    }
+
+    std::size_t tasks;
+    unsigned workers;
+    std::vector<Slot> buffers;
+    std::vector<bool> filled;
+    std::atomic<std::size_t> next = 0;
+    std::size_t written = 0;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable changed;
+};
+
+} // namespace primal::utils
+
+#endif // PRIMAL_ORDERED_PIPELINE_HPP
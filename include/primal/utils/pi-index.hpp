@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file pi-index.hpp
+ * @brief Defines a file of prime counts sampled at regular checkpoints.
+ */
+
+#ifndef PRIMAL_PI_INDEX_HPP
+#define PRIMAL_PI_INDEX_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "primal/utils/io/output-sink.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+
+namespace primal::utils {
+
+/**
+ * Distance between the checkpoints of a newly built pi index.
+ */
+inline constexpr uint64_t piIndexStep = uint64_t{1} << 24;
+
+/**
+ * Read-only view of a pi index file.
+ * @details The file starts with a 32-byte header holding the magic string
+ * "PRIMALPI", the checkpoint step, the ceiling it was built for and the number
+ * of checkpoints, followed by one count per checkpoint. Checkpoint k holds
+ * pi(k * step - 1), the number of primes below k * step. Every value is a
+ * 64-bit integer in native byte order. The file is memory-mapped, so opening
+ * it costs nothing however large it is.
+ */
+class PiIndex {
+public:
+    /**
+     * Map a pi index file.
+     * @param path File to read
+     */
+    explicit PiIndex(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Could not open pi index.");
+        struct stat info;
+        if (::fstat(fd, &info) < 0 ||
+            info.st_size < static_cast<off_t>(headerSize)) {
+            ::close(fd);
+            throw std::runtime_error("Invalid pi index.");
+        }
+
+        bytes = static_cast<std::size_t>(info.st_size);
+        void* address = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED) {
+            throw std::runtime_error("Could not map pi index.");
+        }
+        data = static_cast<const uint64_t*>(address);
+
+        // The step must be a whole number of segments, and the counts must
+        // fill the rest of the file with at least one checkpoint.
+        const std::size_t body = bytes - headerSize;
+        if (std::memcmp(data, magic, sizeof(uint64_t)) != 0 || !step() ||
+            step() % math::segmentSpan || !size() ||
+            body % sizeof(uint64_t) || size() != body / sizeof(uint64_t)) {
+            ::munmap(address, bytes);
+            throw std::runtime_error("Invalid pi index.");
+        }
+    }
+
+    PiIndex(const PiIndex&) = delete;
+    PiIndex& operator=(const PiIndex&) = delete;
+
+    ~PiIndex() { ::munmap(const_cast<uint64_t*>(data), bytes); }
+
+    /**
+     * Distance between neighbouring checkpoints.
+     */
+    uint64_t step() const { return data[1]; }
+
+    /**
+     * Largest number the index was built for.
+     */
+    uint64_t ceiling() const { return data[2]; }
+
+    /**
+     * Number of checkpoints.
+     */
+    uint64_t size() const { return data[3]; }
+
+    /**
+     * Number of primes below a checkpoint.
+     * @param k Zero-based checkpoint
+     * @return pi(k * step - 1)
+     */
+    uint64_t count(uint64_t k) const { return data[4 + k]; }
+
+    /**
+     * Find the last checkpoint at or below a number.
+     * @param number Number to look up
+     * @return Zero-based checkpoint
+     */
+    uint64_t floor(uint64_t number) const {
+        return std::min(number / step(), size() - 1);
+    }
+
+    /**
+     * Find the checkpoint from which the prime with a particular index is
+     * reached first.
+     * @param index One-based prime index, at most count(size() - 1)
+     * @return Last checkpoint with fewer than index primes below it
+     */
+    uint64_t locate(uint64_t index) const {
+        const uint64_t* counts = data + 4;
+        return static_cast<uint64_t>(
+            std::lower_bound(counts, counts + size(), index) - counts - 1);
+    }
+
+    /**
+     * Write a pi index.
+     * @param output Output to write to
+     * @param step Distance between neighbouring checkpoints
+     * @param ceiling Largest number the index was built for
+     * @param counts Number of primes below each checkpoint
+     */
+    static void write(io::OutputSink& output, uint64_t step, uint64_t ceiling,
+                      const std::vector<uint64_t>& counts) {
+        uint64_t header[4] = {0, step, ceiling, counts.size()};
+        std::memcpy(header, magic, sizeof(uint64_t));
+        output.write({reinterpret_cast<const char*>(header), sizeof(header)});
+        output.write({reinterpret_cast<const char*>(counts.data()),
+                      counts.size() * sizeof(uint64_t)});
+    }
+
+private:
+    /**
+     * Magic string at the start of every pi index.
+     */
+    static constexpr char magic[] = "PRIMALPI";
+
+    /**
+     * Size of the header in bytes.
+     */
+    static constexpr std::size_t headerSize = 4 * sizeof(uint64_t);
+
+    const uint64_t* data;
+    std::size_t bytes;
+};
+
+} // namespace primal::utils
+
+#endif // PRIMAL_PI_INDEX_HPP
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file progress.hpp
+ * @brief Defines a class that reports the rate and estimated time remaining of
+ * a long-running job to stderr.
+ */
+
+#ifndef PRIMAL_PROGRESS_HPP
+#define PRIMAL_PROGRESS_HPP
+
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+
+namespace primal::utils {
+
+/**
+ * Reports the progress of a job to stderr periodically or on SIGUSR1.
+ */
+class Progress {
+public:
+    /**
+     * Start tracking the progress of a job.
+     * @param total Amount of work in the whole job
+     * @param done Amount of work already completed by an earlier run
+     * @param periodic Report at a fixed interval, not only on SIGUSR1
+     */
+    Progress(uint64_t total, uint64_t done, bool periodic)
+        : total(total), initial(done), periodic(periodic),
+          start(std::chrono::steady_clock::now()), last(start) {
+        requested = 0;
+        previous = std::signal(SIGUSR1, request);
+    }
+
+    Progress(const Progress&) = delete;
+    Progress& operator=(const Progress&) = delete;
+
+    ~Progress() { std::signal(SIGUSR1, previous); }
+
+    /**
+     * Update the amount of completed work and report it if requested.
+     * @param done Amount of work completed, including earlier runs
+     */
+    void update(uint64_t done) {
+        auto now = std::chrono::steady_clock::now();
+        if (!requested && !(periodic && now - last >= interval)) return;
+        requested = 0;
+        last = now;
+
+        // Rate of this run, which excludes work done by earlier runs.
+        double seconds = std::chrono::duration<double>(now - start).count();
+        double rate = seconds > 0 ? (done - initial) / seconds : 0;
+        double percent = total ? 100.0 * done / total : 100.0;
+
+        std::fprintf(stderr, "Progress: %.2f%%, %.3g numbers/s", percent, rate);
+        if (rate > 0) {
+            auto eta = static_cast<uint64_t>((total - done) / rate);
+            std::fprintf(stderr, ", ETA %02llu:%02llu:%02llu",
+                         static_cast<unsigned long long>(eta / 3600),
+                         static_cast<unsigned long long>(eta / 60 % 60),
+                         static_cast<unsigned long long>(eta % 60));
+        }
+        std::fprintf(stderr, "\n");
+    }
+
+private:
+    /**
+     * SIGUSR1 handler that requests a report at the next update.
+     * @param signal Signal number
+     */
+    static void request(int) { requested = 1; }
+
+    /**
+     * Minimum time between two periodic reports.
+     */
+    static constexpr std::chrono::seconds interval{5};
+
+    /**
+     * Whether a report was requested by a signal.
+     */
+    static inline volatile std::sig_atomic_t requested = 0;
+
+    uint64_t total;
+    uint64_t initial;
+    bool periodic;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point last;
+    void (*previous)(int);
+};
+
+} // namespace primal::utils
+
+#endif // PRIMAL_PROGRESS_HPP
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file query-plan.hpp
+ * @brief Defines a cost-based planner that decides how to answer a batch of
+ * primality tests.
+ */
+
+#ifndef PRIMAL_QUERY_PLAN_HPP
+#define PRIMAL_QUERY_PLAN_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "primal/utils/math/prime-count-bound.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+
+namespace primal::utils {
+
+/**
+ * Represents the ways a group of tests can be answered.
+ */
+enum class Engine {
+    /**
+     * Answered by the sweep from zero that the index queries need anyway.
+     */
+    SWEEP = 0,
+
+    /**
+     * Answered by sieving the interval the tests span.
+     */
+    SIEVE = 1,
+
+    /**
+     * Answered by testing each number with the Miller-Rabin test.
+     */
+    MILLER_RABIN = 2,
+
+    /**
+     * Answered by sieving from the nearest checkpoint of a pi index.
+     */
+    PI_INDEX = 3
+};
+
+/**
+ * A run of neighbouring tests answered by the same engine.
+ */
+struct Cluster {
+    /**
+     * Engine chosen for the tests.
+     */
+    Engine engine;
+
+    /**
+     * Smallest number covered.
+     */
+    uint64_t low;
+
+    /**
+     * Largest number covered.
+     */
+    uint64_t high;
+
+    /**
+     * Range [first, last) of the tests in the sorted list of values.
+     */
+    std::size_t first, last;
+
+    /**
+     * Number of index queries answered.
+     */
+    std::size_t indices;
+
+    /**
+     * Estimated cost of sieving the interval, in nanoseconds.
+     */
+    double sieveCost;
+
+    /**
+     * Estimated cost of testing each number, in nanoseconds.
+     */
+    double testCost;
+};
+
+/**
+ * Estimates the cost of sieving an interval of numbers.
+ * @details Accounts for clearing the bitmap, for finding the first multiple of
+ * every base prime in each segment, and for generating the base primes. The
+ * constants were measured on the segmented sieve and are only meant to be
+ * right to within a small factor.
+ * @param low Smallest number to sieve
+ * @param high Largest number to sieve
+ * @return Estimated cost in nanoseconds
+ */
+inline double sieveCost(uint64_t low, uint64_t high) {
+    using math::isqrt;
+    using math::primeCountUpperBound;
+    using math::segmentSpan;
+
+    double numbers = static_cast<double>(high - low) + 1;
+    double segments = static_cast<double>((high - low) / segmentSpan + 1);
+    uint64_t root = isqrt(high);
+    auto basePrimes = static_cast<double>(primeCountUpperBound(root));
+    return numbers * 0.5 + segments * basePrimes * 6 +
+           static_cast<double>(root) * 0.7;
+}
+
+/**
+ * Estimates the cost of testing a single number with the Miller-Rabin test.
+ * @details Most composites are rejected by the first base, so the average
+ * cost grows with the number of squarings rather than the number of bases.
+ * @param number Number to test
+ * @return Estimated cost in nanoseconds
+ */
+inline double testCost(uint64_t number) {
+    return 70 + 1.6 * std::bit_width(number);
+}
+
+/**
+ * Groups sorted test values into clusters and picks the cheaper engine for
+ * each.
+ * @details Values up to the sweep ceiling are answered by the sweep. The
+ * remaining values are split wherever sieving the gap to the next value would
+ * cost more than testing that value on its own. Neighbouring clusters are then
+ * merged again whenever answering them together is no more expensive, which
+ * smooths over isolated wide gaps. Each cluster is finally sieved or tested,
+ * whichever is estimated to be cheaper.
+ * @param values Numbers to test in ascending order
+ * @param sweepCeiling Ceiling of the sweep from zero, or 0 if there is none
+ * @param indices Number of index queries answered by the sweep
+ * @return Clusters covering every value in order
+ */
+inline std::vector<Cluster> planTests(const std::vector<uint64_t>& values,
+                                      uint64_t sweepCeiling,
+                                      std::size_t indices = 0) {
+    auto cost = [](const Cluster& cluster) {
+        return std::min(cluster.sieveCost, cluster.testCost);
+    };
+    std::vector<Cluster> plan;
+    std::size_t i = 0;
+
+    if (sweepCeiling) {
+        while (i < values.size() && values[i] <= sweepCeiling) i++;
+        plan.push_back({Engine::SWEEP, 0, sweepCeiling, 0, i, indices,
+                        sieveCost(0, sweepCeiling), 0});
+    }
+
+    while (i < values.size()) {
+        Cluster cluster{Engine::SIEVE, values[i], values[i], i, i + 1, 0, 0,
+                        testCost(values[i])};
+
+        // Grow the cluster while bridging the gap is cheaper than a test.
+        for (i++; i < values.size(); i++) {
+            double gap = sieveCost(cluster.high, values[i]) -
+                         sieveCost(cluster.high, cluster.high);
+            if (gap > testCost(values[i])) break;
+            cluster.high = values[i];
+            cluster.last = i + 1;
+            cluster.testCost += testCost(values[i]);
+        }
+
+        cluster.sieveCost = sieveCost(cluster.low, cluster.high);
+
+        // Absorb earlier clusters while one cluster is no dearer than two.
+        while (!plan.empty() && plan.back().engine != Engine::SWEEP) {
+            Cluster merged = plan.back();
+            merged.high = cluster.high;
+            merged.last = cluster.last;
+            merged.sieveCost = sieveCost(merged.low, merged.high);
+            merged.testCost += cluster.testCost;
+            if (cost(merged) > cost(plan.back()) + cost(cluster)) break;
+            cluster = merged;
+            plan.pop_back();
+        }
+
+        cluster.engine = cluster.testCost < cluster.sieveCost
+                             ? Engine::MILLER_RABIN
+                             : Engine::SIEVE;
+        plan.push_back(cluster);
+    }
+    return plan;
+}
+
+/**
+ * Describes a plan as a table with one row per cluster.
+ * @param plan Clusters to describe
+ * @param direct Number of tests answered without any engine
+ * @return Table text
+ */
+inline std::string explainPlan(const std::vector<Cluster>& plan,
+                               std::size_t direct) {
+    static constexpr const char* names[] = {"sweep", "sieve", "miller-rabin",
+                                            "pi-index"};
+
+    char line[160];
+    std::string text;
+    std::snprintf(line, sizeof(line), "%-13s %20s %20s %9s %9s %13s %13s\n",
+                  "Engine", "Low", "High", "Indices", "Tests", "Sieve (ms)",
+                  "Test (ms)");
+    text += line;
+
+    if (direct) {
+        std::snprintf(line, sizeof(line),
+                      "%-13s %20s %20s %9s %9zu %13s %13s\n", "direct", "-",
+                      "-", "-", direct, "-", "-");
+        text += line;
+    }
+    for (const Cluster& cluster : plan) {
+        char test[32] = "-";
+        if (cluster.engine == Engine::SIEVE ||
+            cluster.engine == Engine::MILLER_RABIN) {
+            std::snprintf(test, sizeof(test), "%.4g", cluster.testCost / 1e6);
+        }
+        std::snprintf(line, sizeof(line),
+                      "%-13s %20llu %20llu %9zu %9zu %13.4g %13s\n",
+                      names[static_cast<int>(cluster.engine)],
+                      static_cast<unsigned long long>(cluster.low),
+                      static_cast<unsigned long long>(cluster.high),
+                      cluster.indices,
+                      cluster.last - cluster.first, cluster.sieveCost / 1e6,
+                      test);
+        text += line;
+    }
+    return text;
+}
+
+} // namespace primal::utils
+
+#endif // PRIMAL_QUERY_PLAN_HPP
@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file shard.hpp
+ * @brief Defines how a segmented job is split into shards that run on
+ * separate machines, and the partial-result file each shard writes.
+ */
+
+#ifndef PRIMAL_SHARD_HPP
+#define PRIMAL_SHARD_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "primal/utils/io/output-sink.hpp"
+#include "primal/utils/math/prime-count-bound.hpp"
+#include "primal/utils/math/prime-search.hpp"
+#include "primal/utils/math/segmented-sieve.hpp"
+#include "primal/utils/string/parse.hpp"
+#include "primal/utils/uint128.hpp"
+
+namespace primal::utils {
+
+/**
+ * One of several parts of a job that run independently.
+ */
+struct Shard {
+    /**
+     * One-based number of the shard.
+     */
+    uint64_t index = 0;
+
+    /**
+     * Number of shards the job is split into, or 0 if it is not split.
+     */
+    uint64_t count = 0;
+
+    /**
+     * Parse a shard written as "K/N".
+     * @param text Shard to parse
+     * @return Shard K of N
+     */
+    static Shard parse(const std::string& text) {
+        auto separator = text.find('/');
+        if (separator == std::string::npos) {
+            throw std::runtime_error("Invalid shard.");
+        }
+        Shard shard{string::parse<uint64_t>(text.substr(0, separator)),
+                    string::parse<uint64_t>(text.substr(separator + 1))};
+        if (!shard.index || shard.index > shard.count) {
+            throw std::runtime_error("Invalid shard.");
+        }
+        return shard;
+    }
+};
+
+/**
+ * Estimates the cost of one segment of a job.
+ * @details Uses the constants of the query planner's sieve cost for the bitmap
+ * and the base primes, and about 22 ns for every line that a list writes. Base
+ * primes make later segments dearer, while the thinning primes make listing
+ * them cheaper.
+ * @param low Smallest number in the segment
+ * @param listing Whether the primes of the segment are written out
+ * @return Estimated cost in nanoseconds
+ */
+inline double segmentCost(uint64_t low, bool listing) {
+    using math::isqrt;
+    using math::primeCountUpperBound;
+    using math::segmentSpan;
+
+    uint64_t high = low + (segmentSpan - 1);
+    double span = static_cast<double>(segmentSpan);
+    double cost = span * 0.5 +
+                  static_cast<double>(primeCountUpperBound(isqrt(high))) * 6;
+    if (listing) cost += span / std::log(static_cast<double>(high)) * 22;
+    return cost;
+}
+
+/**
+ * Calculates the segments processed by a shard.
+ * @details The segments are split into blocks, and the estimated cost of each
+ * block is summed in order. Shard K starts where the running cost reaches
+ * (K - 1) / N of the total, interpolating within a block, so every shard gets
+ * about the same amount of work. The split only depends on its arguments, so
+ * every machine computes the same one.
+ * @tparam T Unsigned integer type
+ * @param ceiling Largest number of the whole job
+ * @param shard Shard to calculate
+ * @param listing Whether the job writes out every prime
+ * @return First segment of the shard and the first segment after it
+ */
+template <typename T>
+requires std::is_unsigned_v<T>
+std::pair<uint64_t, uint64_t> shardSegments(T ceiling, const Shard& shard,
+                                            bool listing) {
+    using math::segmentCount;
+    using math::segmentSpan;
+
+    const uint64_t segments = segmentCount(ceiling);
+    const uint64_t blocks = std::min<uint64_t>(segments, uint64_t{1} << 16);
+
+    // Running cost at the start of every block.
+    std::vector<double> costs{0};
+    costs.reserve(blocks + 1);
+    auto start = [&](uint64_t block) {
+        return static_cast<uint64_t>(
+            static_cast<uint128_t>(segments) * block / blocks);
+    };
+    for (uint64_t block = 0; block < blocks; block++) {
+        uint64_t size = start(block + 1) - start(block);
+        uint64_t middle = start(block) + size / 2;
+        costs.push_back(costs.back() + static_cast<double>(size) *
+                                           segmentCost(middle * segmentSpan,
+                                                       listing));
+    }
+
+    // Segment at which the running cost reaches a fraction of the total.
+    auto boundary = [&](uint64_t k) {
+        if (k == 0) return uint64_t{0};
+        if (k == shard.count) return segments;
+        double target = costs.back() * static_cast<double>(k) /
+                        static_cast<double>(shard.count);
+        auto it = std::upper_bound(costs.begin(), costs.end(), target);
+        auto block = static_cast<uint64_t>(it - costs.begin() - 1);
+        if (block >= blocks) return segments;
+        double fraction = (target - costs[block]) /
+                          (costs[block + 1] - costs[block]);
+        uint64_t size = start(block + 1) - start(block);
+        return start(block) +
+               std::min(size, static_cast<uint64_t>(
+                                  fraction * static_cast<double>(size)));
+    };
+    return {boundary(shard.index - 1), boundary(shard.index)};
+}
+
+/**
+ * Result of one shard, from which the results of every shard are merged.
+ */
+struct Partial {
+    /**
+     * Name of the function performed ("list" or "count").
+     */
+    std::string function;
+
+    /**
+     * Largest number of the whole job.
+     */
+    uint64_t ceiling = 0;
+
+    /**
+     * One-based number of the shard.
+     */
+    uint64_t shard = 0;
+
+    /**
+     * Number of shards the job is split into.
+     */
+    uint64_t shards = 0;
+
+    /**
+     * First segment processed by the shard.
+     */
+    uint64_t begin = 0;
+
+    /**
+     * First segment after the ones processed by the shard.
+     */
+    uint64_t end = 0;
+
+    /**
+     * Number of primes found by the shard.
+     */
+    uint64_t count = 0;
+
+    /**
+     * Smallest prime found by the shard, or 0 if it found none.
+     */
+    uint64_t first = 0;
+
+    /**
+     * Largest prime found by the shard, or 0 if it found none.
+     */
+    uint64_t last = 0;
+
+    /**
+     * File holding the output lines of the shard, or an empty string.
+     * @details Written as a name in the directory of the partial result, so
+     * that partial results can be moved together with their data files, and
+     * resolved against that directory when loaded.
+     */
+    std::string data;
+
+    /**
+     * Number of bytes written to the data file.
+     */
+    uint64_t bytes = 0;
+
+    /**
+     * Describe the result of a shard, including the primes at its edges.
+     * @tparam T Unsigned integer type
+     * @param function Name of the function performed
+     * @param ceiling Largest number of the whole job
+     * @param shard Shard that was processed
+     * @param begin First segment processed
+     * @param end First segment after the ones processed
+     * @param count Number of primes found
+     * @return Partial result without a data file
+     */
+    template <typename T>
+    requires std::is_unsigned_v<T>
+    static Partial of(std::string function, T ceiling, const Shard& shard,
+                      uint64_t begin, uint64_t end, uint64_t count) {
+        Partial partial;
+        partial.function = std::move(function);
+        partial.ceiling = ceiling;
+        partial.shard = shard.index;
+        partial.shards = shard.count;
+        partial.begin = begin;
+        partial.end = end;
+        partial.count = count;
+        if (begin < end) {
+            T low, high, unused;
+            math::segmentBounds(begin, ceiling, low, unused);
+            math::segmentBounds(end - 1, ceiling, unused, high);
+            partial.findBoundaries(low, high);
+        }
+        return partial;
+    }
+
+    /**
+     * Find the smallest and largest primes in a range.
+     * @tparam T Unsigned integer type
+     * @param low Smallest number of the range
+     * @param high Largest number of the range
+     */
+    template <typename T>
+    requires std::is_unsigned_v<T>
+    void findBoundaries(T low, T high) {
+        using math::nextPrimes;
+        using math::previousPrimes;
+
+        first = last = 0;
+        auto above = nextPrimes(low ? static_cast<T>(low - 1) : T{0}, 1);
+        if (above.empty() || above[0] > high) return;
+        first = above[0];
+        last = high == std::numeric_limits<T>::max()
+                   ? previousPrimes(high, 1)[0]
+                   : previousPrimes(static_cast<T>(high + 1), 1)[0];
+    }
+
+    /**
+     * Write the partial result.
+     * @param output Output to write to
+     */
+    void write(io::OutputSink& output) const {
+        output.write("function=" + function + "\n" +
+                     "ceiling=" + std::to_string(ceiling) + "\n" +
+                     "shard=" + std::to_string(shard) + "\n" +
+                     "shards=" + std::to_string(shards) + "\n" +
+                     "begin=" + std::to_string(begin) + "\n" +
+                     "end=" + std::to_string(end) + "\n" +
+                     "count=" + std::to_string(count) + "\n" +
+                     "first=" + std::to_string(first) + "\n" +
+                     "last=" + std::to_string(last) + "\n" +
+                     "data=" + data + "\n" +
+                     "bytes=" + std::to_string(bytes) + "\n");
+    }
+
+    /**
+     * Load a partial result from a file.
+     * @param path File to read
+     * @return Partial result stored in the file
+     */
+    static Partial load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) throw std::runtime_error("Could not read partial result.");
+
+        // Read the key=value pairs.
+        std::map<std::string, std::string> values;
+        for (std::string line; std::getline(file, line);) {
+            auto separator = line.find('=');
+            if (separator == std::string::npos) continue;
+            values[line.substr(0, separator)] = line.substr(separator + 1);
+        }
+
+        Partial partial;
+        try {
+            auto number = [&](const char* key) {
+                return string::parse<uint64_t>(values.at(key));
+            };
+            partial.function = values.at("function");
+            partial.ceiling = number("ceiling");
+            partial.shard = number("shard");
+            partial.shards = number("shards");
+            partial.begin = number("begin");
+            partial.end = number("end");
+            partial.count = number("count");
+            partial.first = number("first");
+            partial.last = number("last");
+            partial.data = values.at("data");
+            if (!partial.data.empty()) {
+                partial.data = (std::filesystem::path(path).parent_path() /
+                                partial.data)
+                                   .string();
+            }
+            partial.bytes = number("bytes");
+        } catch (const std::out_of_range&) {
+            throw std::runtime_error("Partial result is incomplete.");
+        }
+        return partial;
+    }
+};
+
+} // namespace primal::utils
+
+#endif // PRIMAL_SHARD_HPP
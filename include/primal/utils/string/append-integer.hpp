@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file append-integer.hpp
+ * @brief Defines a function template that appends the decimal representation
+ * of an integer to a string.
+ */
+
+#ifndef PRIMAL_APPEND_INTEGER_HPP
+#define PRIMAL_APPEND_INTEGER_HPP
+
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "primal/utils/uint128.hpp"
+
+namespace primal::utils::string {
+
+/**
+ * Appends the decimal representation of an integer to a string.
+ * @details Avoids the format string parsing and locale handling of printf,
+ * which dominates the cost of printing long lists of numbers.
+ * @tparam T Integer type
+ * @param text String to append to
+ * @param value Integer to append
+ */
+template <typename T>
+requires std::is_integral_v<T> || std::same_as<T, uint128_t>
+void appendInteger(std::string& text, T value) {
+    if constexpr (std::same_as<T, uint128_t>) {
+        if (value <= UINT64_MAX) {
+            appendInteger(text, static_cast<uint64_t>(value));
+            return;
+        }
+
+        // std::to_chars has no 128-bit overload, so print 19 digits at a time.
+        constexpr uint64_t chunk = 10'000'000'000'000'000'000u;
+        appendInteger(text, value / chunk);
+        std::string low;
+        appendInteger(low, static_cast<uint64_t>(value % chunk));
+        text.append(19 - low.size(), '0');
+        text += low;
+    } else {
+        char digits[24];
+        auto [end, error] =
+            std::to_chars(digits, digits + sizeof(digits), value);
+        text.append(digits, end);
+    }
+}
+
+} // namespace primal::utils::string
+
+#endif // PRIMAL_APPEND_INTEGER_HPP
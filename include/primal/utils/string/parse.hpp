@@ -33,6 +33,8 @@
 #include <string>
 #include <type_traits>
 
+#include "primal/utils/uint128.hpp"
+
 namespace primal::utils::string {
 
 /**
@@ -87,6 +89,73 @@ T parse(const std::string& text) {
     return static_cast<T>(parse<std::underlying_type_t<T>>(text));
 }
 
+/**
+ * Parses a numeric string of up to 39 digits to a 128-bit unsigned integer.
+ * @details strtoull() stops at 64 bits, so the digits are accumulated
+ * directly.
+ * @tparam T uint128_t
+ * @param text Numeric string
+ * @return Numeric value
+ */
+template <typename T>
+requires std::same_as<T, uint128_t>
+T parse(const std::string& text) {
+    constexpr T limit = std::numeric_limits<T>::max() / 10;
+    constexpr unsigned lastDigit = std::numeric_limits<T>::max() % 10;
+    if (text.empty()) {
+        throw std::runtime_error("String was not a valid numeric value.");
+    }
+
+    T value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            throw std::runtime_error("String was not a valid numeric value.");
+        }
+        auto digit = static_cast<unsigned>(c - '0');
+        if (value > limit || (value == limit && digit > lastDigit)) {
+            throw std::runtime_error("Numeric value of string was out of range "
+                                     "for the requested numeric type.");
+        }
+        value = value * 10 + digit;
+    }
+    return value;
+}
+
+/**
+ * Parses a numeric string that may be written as a power (such as "10^9") to
+ * the requested unsigned integer type.
+ * @tparam T Unsigned integer return type
+ * @param text Numeric string or power expression
+ * @return Numeric value
+ */
+template <typename T>
+requires UnsignedInteger<T>
+T parseExpression(const std::string& text) {
+    auto caret = text.find('^');
+    if (caret == std::string::npos) return parse<T>(text);
+
+    // Powers of 0 and 1 never overflow, and any larger base overflows within
+    // as many steps as T has bits, so the loop below stays short.
+    T base = parse<T>(text.substr(0, caret));
+    T exponent = parse<T>(text.substr(caret + 1));
+    if (base <= 1) return exponent == 0 ? T{1} : base;
+    if (exponent >= std::numeric_limits<T>::digits) {
+        throw std::runtime_error("Numeric value of string was out of range "
+                                 "for the requested numeric type.");
+    }
+
+    // Raise the base to the exponent, checking every step for overflow.
+    T value = 1;
+    for (T i = 0; i < exponent; i++) {
+        if (base && value > std::numeric_limits<T>::max() / base) {
+            throw std::runtime_error("Numeric value of string was out of range "
+                                     "for the requested numeric type.");
+        }
+        value *= base;
+    }
+    return value;
+}
+
 } // namespace primal::utils::string
 
 #endif // PRIMAL_PARSE_HPP
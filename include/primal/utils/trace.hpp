@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file trace.hpp
+ * @brief Defines a low-overhead recorder of per-thread timeline events that
+ * are exported in the Chrome trace-event format.
+ */
+
+#ifndef PRIMAL_TRACE_HPP
+#define PRIMAL_TRACE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "primal/utils/string/append-integer.hpp"
+
+namespace primal::utils::trace {
+
+/**
+ * Number of events kept per thread; older events are overwritten.
+ */
+inline constexpr std::size_t ringSize = std::size_t{1} << 16;
+
+/**
+ * A span of time spent by a thread on one step of the work.
+ */
+struct Event {
+    /**
+     * Name of the step (a string literal).
+     */
+    const char* name;
+
+    /**
+     * Name of the argument recorded with the step, or nullptr if there is
+     * none (a string literal).
+     */
+    const char* argName;
+
+    /**
+     * Value of the argument.
+     */
+    uint64_t arg;
+
+    /**
+     * Start time in nanoseconds of the steady clock.
+     */
+    uint64_t start;
+
+    /**
+     * End time in nanoseconds of the steady clock.
+     */
+    uint64_t end;
+};
+
+/**
+ * Events recorded by a single thread.
+ * @details Only the owning thread writes to a ring, so recording an event
+ * needs neither a lock nor an atomic operation. A thread hands its ring back
+ * when it exits, and the next new thread takes it over, so there are never
+ * more rings than threads alive at once however many pipelines are run. The
+ * rings are read once every worker thread has been joined.
+ */
+struct Ring {
+    /**
+     * Name shown for the thread.
+     */
+    std::string name = "thread";
+
+    /**
+     * Storage for the most recent events.
+     */
+    std::vector<Event> events = std::vector<Event>(ringSize);
+
+    /**
+     * Number of events recorded, including overwritten ones.
+     */
+    uint64_t recorded = 0;
+
+    /**
+     * Whether a running thread records into the ring.
+     */
+    bool owned = false;
+};
+
+/**
+ * Memory held by the ring of one thread in bytes.
+ */
+inline constexpr std::size_t ringBytes = ringSize * sizeof(Event);
+
+/**
+ * Whether events are being recorded.
+ */
+inline std::atomic<bool> enabled = false;
+
+/**
+ * Rings of every thread that has recorded an event.
+ */
+inline std::vector<std::unique_ptr<Ring>> rings;
+
+/**
+ * Guards the list of rings.
+ */
+inline std::mutex ringsMutex;
+
+/**
+ * Check whether events are being recorded.
+ * @return True if tracing is enabled
+ */
+inline bool active() { return enabled.load(std::memory_order_relaxed); }
+
+/**
+ * Read the steady clock.
+ * @return Nanoseconds since the steady clock's epoch
+ */
+inline uint64_t now() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+/**
+ * Get the ring of the calling thread, taking over the ring of a thread that
+ * has exited or creating one on first use.
+ * @return Ring of the calling thread
+ */
+inline Ring& localRing() {
+    // Hands the ring back when the thread exits.
+    struct Owner {
+        Ring* ring = nullptr;
+
+        ~Owner() {
+            if (!ring) return;
+            std::lock_guard lock(ringsMutex);
+            ring->owned = false;
+        }
+    };
+
+    thread_local Owner owner;
+    if (!owner.ring) {
+        std::lock_guard lock(ringsMutex);
+        auto spare = std::find_if(rings.begin(), rings.end(),
+                                  [](const auto& ring) { return !ring->owned; });
+        if (spare == rings.end()) {
+            rings.push_back(std::make_unique<Ring>());
+            spare = rings.end() - 1;
+        }
+        owner.ring = spare->get();
+        owner.ring->owned = true;
+    }
+    return *owner.ring;
+}
+
+/**
+ * Set the name shown for the calling thread if tracing is enabled.
+ * @param name Thread name
+ */
+inline void nameThread(const char* name) {
+    if (active()) localRing().name = name;
+}
+
+/**
+ * Records the time between its construction and destruction as an event.
+ * @details Costs a single relaxed load when tracing is disabled.
+ */
+class Span {
+public:
+    /**
+     * Start a span.
+     * @param name Name of the step (a string literal)
+     * @param argName Name of the argument (a string literal), or nullptr
+     * @param arg Value of the argument
+     */
+    explicit Span(const char* name, const char* argName = nullptr,
+                  uint64_t arg = 0)
+        : name(name), argName(argName), arg(arg),
+          start(active() ? now() : 0) {}
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    ~Span() {
+        if (!start) return;
+        Ring& ring = localRing();
+        ring.events[ring.recorded++ % ringSize] = {name, argName, arg, start,
+                                                   now()};
+    }
+
+private:
+    const char* name;
+    const char* argName;
+    uint64_t arg;
+    uint64_t start;
+};
+
+/**
+ * Start recording events.
+ * @details Must be called before any worker thread is started.
+ */
+inline void start() {
+    enabled = true;
+    nameThread("main");
+}
+
+/**
+ * Append a time in microseconds with nanosecond precision.
+ * @param text String to append to
+ * @param nanoseconds Time in nanoseconds
+ */
+inline void appendMicroseconds(std::string& text, uint64_t nanoseconds) {
+    using string::appendInteger;
+
+    appendInteger(text, nanoseconds / 1000);
+    uint64_t fraction = nanoseconds % 1000;
+    text += '.';
+    text += static_cast<char>('0' + fraction / 100);
+    text += static_cast<char>('0' + fraction / 10 % 10);
+    text += static_cast<char>('0' + fraction % 10);
+}
+
+/**
+ * Write every recorded event to a file in the Chrome trace-event format,
+ * which Perfetto and chrome://tracing open directly.
+ * @details Must be called after every worker thread has been joined.
+ * @param path File to write
+ */
+inline void write(const std::string& path) {
+    using string::appendInteger;
+
+    std::lock_guard lock(ringsMutex);
+
+    // Times are shown relative to the first event.
+    uint64_t origin = UINT64_MAX;
+    for (const auto& ring : rings) {
+        uint64_t first = ring->recorded > ringSize ? ring->recorded - ringSize
+                                                   : 0;
+        for (uint64_t i = first; i < ring->recorded; i++) {
+            origin = std::min(origin, ring->events[i % ringSize].start);
+        }
+    }
+
+    std::string text = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool firstEvent = true;
+    auto separate = [&] {
+        if (!firstEvent) text += ",\n";
+        firstEvent = false;
+    };
+    for (std::size_t tid = 0; tid < rings.size(); tid++) {
+        const Ring& ring = *rings[tid];
+        separate();
+        text += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+        appendInteger(text, tid);
+        text += ",\"args\":{\"name\":\"" + ring.name + "\"}}";
+
+        uint64_t first = ring.recorded > ringSize ? ring.recorded - ringSize
+                                                  : 0;
+        for (uint64_t i = first; i < ring.recorded; i++) {
+            const Event& event = ring.events[i % ringSize];
+            separate();
+            text += "{\"name\":\"";
+            text += event.name;
+            text += "\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+            appendInteger(text, tid);
+            text += ",\"ts\":";
+            appendMicroseconds(text, event.start - origin);
+            text += ",\"dur\":";
+            appendMicroseconds(text, event.end - event.start);
+            if (event.argName) {
+                text += ",\"args\":{\"";
+                text += event.argName;
+                text += "\":";
+                appendInteger(text, event.arg);
+                text += '}';
+            }
+            text += '}';
+        }
+    }
+    text += "]}\n";
+
+    std::ofstream file(path, std::ios::binary);
+    file << text;
+    if (!file) throw std::runtime_error("Could not write trace file.");
+}
+
+} // namespace primal::utils::trace
+
+#endif // PRIMAL_TRACE_HPP
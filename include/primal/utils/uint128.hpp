@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file uint128.hpp
+ * @brief Defines the 128-bit unsigned integer type, a concept for every
+ * unsigned integer type including it, and helpers that work on both.
+ */
+
+#ifndef PRIMAL_UINT128_HPP
+#define PRIMAL_UINT128_HPP
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+
+namespace primal::utils {
+
+/**
+ * Unsigned 128-bit integer.
+ * @details The standard type traits only count it as an integer with the GNU
+ * extensions enabled, so templates that accept it use UnsignedInteger instead
+ * of std::is_unsigned_v.
+ */
+__extension__ using uint128_t = unsigned __int128;
+
+/**
+ * Any unsigned integer type, including uint128_t.
+ */
+template <typename T>
+concept UnsignedInteger = std::is_unsigned_v<T> || std::same_as<T, uint128_t>;
+
+/**
+ * Calculates the number of bits needed to represent a number.
+ * @tparam T Unsigned integer type, including uint128_t
+ * @param value Number to measure
+ * @return Position of the highest set bit plus one, or 0 for 0
+ */
+template <typename T>
+requires UnsignedInteger<T>
+int bitWidth(T value) {
+    if constexpr (sizeof(T) > sizeof(uint64_t)) {
+        if (auto high = static_cast<uint64_t>(value >> 64)) {
+            return 64 + std::bit_width(high);
+        }
+    }
+    return std::bit_width(static_cast<uint64_t>(value));
+}
+
+} // namespace primal::utils
+
+#endif // PRIMAL_UINT128_HPP
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2024 Emma Casey
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Emma Casey
+ * @date 2026-10-19
+ * @file kernels.cpp
+ * @brief Defines the hot loops of the sieve, which are built for several
+ * instruction sets and selected at startup.
+ */
+
+#include "primal/utils/math/kernels.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+// Build every kernel for each x86-64 microarchitecture level and let the
+// dynamic loader resolve the best one for the running CPU (GNU ifunc).
+#if defined(__x86_64__) && defined(__ELF__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define PRIMAL_DISPATCH                                                        \
+    __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3",           \
+                                 "arch=x86-64-v2", "default")))
+#endif
+#endif
+#ifndef PRIMAL_DISPATCH
+#define PRIMAL_DISPATCH
+#endif
+
+namespace {
+
+/**
+ * Pairs of decimal digits for every number from 00 to 99.
+ */
+constexpr char digitPairs[] = "00010203040506070809"
+                              "10111213141516171819"
+                              "20212223242526272829"
+                              "30313233343536373839"
+                              "40414243444546474849"
+                              "50515253545556575859"
+                              "60616263646566676869"
+                              "70717273747576777879"
+                              "80818283848586878889"
+                              "90919293949596979899";
+
+/**
+ * Write the decimal representation of a number.
+ * @param out Output buffer with room for 20 characters
+ * @param value Number to write
+ * @return Pointer past the last character written
+ */
+inline char* writeDecimal(char* out, uint64_t value) {
+    char digits[20];
+    char* end = digits + sizeof(digits);
+    char* start = end;
+
+    // Convert two digits at a time from the right.
+    while (value >= 100) {
+        start -= 2;
+        std::memcpy(start, digitPairs + (value % 100) * 2, 2);
+        value /= 100;
+    }
+    if (value >= 10) {
+        start -= 2;
+        std::memcpy(start, digitPairs + value * 2, 2);
+    } else {
+        *--start = static_cast<char>('0' + value);
+    }
+
+    std::memcpy(out, start, static_cast<std::size_t>(end - start));
+    return out + (end - start);
+}
+
+/**
+ * Clear every step-th bit of a bitmap, eight bits per pass.
+ * @details Eight consecutive multiples of an odd step are exactly step bytes
+ * apart, so the byte offsets (beyond a multiple of step / 8) and the masks of
+ * the eight bits cleared in a pass only depend on step % 8 and start % 8. Each
+ * combination gets its own kernel, which clears its eight bits at offsets and
+ * with masks fixed at compile time and then moves on by step bytes, without a
+ * branch per bit. Bits past the last full pass are cleared one at a time.
+ * @tparam Residue Step modulo 8
+ * @tparam Start Starting bit modulo 8
+ * @param bytes Bitmap to update, in little-endian byte order
+ * @param bits Number of bits in the bitmap
+ * @param start Index of the first bit to clear
+ * @param step Distance between cleared bits
+ */
+template <unsigned Residue, unsigned Start>
+void crossOffWheel(uint8_t* bytes, std::size_t bits, std::size_t start,
+                   std::size_t step) {
+    constexpr auto offset = [](std::size_t k) {
+        return (Start + k * Residue) / 8;
+    };
+    constexpr auto mask = [](std::size_t k) {
+        return static_cast<uint8_t>(~(1U << ((Start + k * Residue) % 8)));
+    };
+
+    const std::size_t stride = step / 8;
+    uint8_t* base = bytes + start / 8;
+    std::size_t j = start;
+    for (; j + 7 * step < bits; j += 8 * step, base += step) {
+        [&]<std::size_t... K>(std::index_sequence<K...>) {
+            ((base[K * stride + offset(K)] &= mask(K)), ...);
+        }(std::make_index_sequence<8>{});
+    }
+    for (; j < bits; j += step) {
+        bytes[j / 8] &= static_cast<uint8_t>(~(1U << (j % 8)));
+    }
+}
+
+/**
+ * Signature of the crossing-off kernels.
+ */
+using CrossOffKernel = void (*)(uint8_t*, std::size_t, std::size_t,
+                                std::size_t);
+
+/**
+ * Build the table of crossing-off kernels.
+ * @return Kernel for odd step residue 2i + 1 and start residue s at 8i + s
+ */
+template <std::size_t... I>
+constexpr std::array<CrossOffKernel, sizeof...(I)>
+makeCrossOffKernels(std::index_sequence<I...>) {
+    return {&crossOffWheel<(I / 8) * 2 + 1, I % 8>...};
+}
+
+/**
+ * Crossing-off kernels for every odd step residue and start residue mod 8.
+ */
+constexpr auto crossOffKernels =
+    makeCrossOffKernels(std::make_index_sequence<32>{});
+
+} // namespace
+
+namespace primal::utils::math::kernels {
+
+PRIMAL_DISPATCH
+void fillBits(uint64_t* words, std::size_t bits) {
+    std::size_t full = bits / 64;
+    for (std::size_t i = 0; i < full; i++) words[i] = ~uint64_t{0};
+    if (bits % 64) words[full] = (uint64_t{1} << (bits % 64)) - 1;
+}
+
+PRIMAL_DISPATCH
+void crossOff(uint64_t* words, std::size_t bits, std::size_t start,
+              std::size_t step) {
+    // Odd steps with at least one full pass go to their wheel kernel.
+    if constexpr (std::endian::native == std::endian::little) {
+        if (step % 2 && start + 7 * step < bits) {
+            auto kernel = crossOffKernels[(step % 8) / 2 * 8 + start % 8];
+            kernel(reinterpret_cast<uint8_t*>(words), bits, start, step);
+            return;
+        }
+    }
+
+    for (std::size_t j = start; j < bits; j += step) {
+        words[j / 64] &= ~(uint64_t{1} << (j % 64));
+    }
+}
+
+PRIMAL_DISPATCH
+uint64_t popcount(const uint64_t* words, std::size_t count) {
+    uint64_t total = 0;
+    for (std::size_t i = 0; i < count; i++) total += std::popcount(words[i]);
+    return total;
+}
+
+PRIMAL_DISPATCH
+uint64_t andPopcount(const uint64_t* first, const uint64_t* second,
+                     unsigned shift, std::size_t count) {
+    uint64_t total = 0;
+    if (!shift) {
+        for (std::size_t i = 0; i < count; i++) {
+            total += std::popcount(first[i] & second[i]);
+        }
+        return total;
+    }
+
+    // Join neighbouring words to line the second bitmap up with the first.
+    for (std::size_t i = 0; i < count; i++) {
+        uint64_t word = (second[i] >> shift) | (second[i + 1] << (64 - shift));
+        total += std::popcount(first[i] & word);
+    }
+    return total;
+}
+
+PRIMAL_DISPATCH
+void maskedPopcount(const uint64_t* words, std::size_t count,
+                    const uint64_t* masks, std::size_t classes,
+                    std::size_t period, std::size_t phase, std::size_t stride,
+                    uint64_t* counts) {
+    for (std::size_t i = 0; i < count; i++) {
+        if (uint64_t word = words[i]) {
+            const uint64_t* row = masks + phase * classes;
+            for (std::size_t c = 0; c < classes; c++) {
+                counts[c] += std::popcount(word & row[c]);
+            }
+        }
+        phase += stride;
+        if (phase >= period) phase -= period;
+    }
+}
+
+PRIMAL_DISPATCH
+std::size_t extractBits(const uint64_t* words, std::size_t count,
+                        uint32_t* indices) {
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        for (uint64_t word = words[i]; word; word &= word - 1) {
+            indices[found++] = static_cast<uint32_t>(i * 64 +
+                                                     std::countr_zero(word));
+        }
+    }
+    return found;
+}
+
+PRIMAL_DISPATCH
+std::size_t formatPrimeLines(char* out, uint64_t index, const uint64_t* primes,
+                             std::size_t count) {
+    char* cursor = out;
+    for (std::size_t i = 0; i < count; i++) {
+        std::memcpy(cursor, "Prime #", 7);
+        cursor = writeDecimal(cursor + 7, ++index);
+        std::memcpy(cursor, " = ", 3);
+        cursor = writeDecimal(cursor + 3, primes[i]);
+        *cursor++ = '\n';
+    }
+    return static_cast<std::size_t>(cursor - out);
+}
+
+const char* instructionSet() {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    if (__builtin_cpu_supports("x86-64-v4")) return "x86-64-v4 (AVX-512)";
+    if (__builtin_cpu_supports("x86-64-v3")) return "x86-64-v3 (AVX2)";
+    if (__builtin_cpu_supports("x86-64-v2")) return "x86-64-v2 (SSE4.2)";
+    return "x86-64 (baseline)";
+#else
+    return "portable";
+#endif
+}
+
+} // namespace primal::utils::math::kernels
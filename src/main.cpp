@@ -51,7 +51,7 @@ int main(int argc, char** argv) {
             break;
         }
     } catch (const std::exception& e) {
-        std::cerr << "Error: " << std::endl;
+        std::cerr << "Error: " << e.what() << std::endl;
         return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
@@ -24,15 +24,28 @@
 
 #include "primal/options.hpp"
 
+#include <unistd.h>
+
 #include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <istream>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "cxxopts.hpp"
+#include "primal/utils/checkpoint.hpp"
+#include "primal/utils/string/parse.hpp"
 
 primal::Options::Options(int argc, char** argv)
-    : opts(argv[0], description), function(Function::INTERACTIVE), indexArg(0),
-      listArg(0), testArg(0) {
+    : opts(argv[0], description), function(Function::INTERACTIVE), listArg(0),
+      countArg(0),
+      tableArg(utils::math::ArithmeticFunction::SPF), ceilingArg(0),
+      buildIndexArg(0), adjacentArg(0), primesArg(1),
+      goldbachLowArg(0), goldbachHighArg(0), witnessesArg(false),
+      rangeLowArg(0), rangeHighArg(0), residuesArg(0), intervalArg(0) {
     addOptions();
     parseOptions(argc, argv);
 }
@@ -42,15 +55,135 @@ std::string primal::Options::getHelpText() const { return opts.help(); }
 void primal::Options::addOptions() {
     using cxxopts::value;
 
-    opts.add_options()("i,index", "Print the prime with a particular index.",
-                       value<uint64_t>()->default_value("0"));
+    opts.add_options()("i,index",
+                       "Print the prime with a particular index (repeatable, "
+                       "comma-separated, powers like 10^9 allowed).",
+                       value<std::vector<std::string>>());
+
+    opts.add_options()("batch",
+                       "Read index and test queries from a file, one per "
+                       "line as 'index N' or 'test N' ('-' for stdin).",
+                       value<std::string>()->default_value(""));
+
+    opts.add_options()("explain",
+                       "Print how the queries would be answered, with the "
+                       "estimated cost of each step, instead of answering "
+                       "them.",
+                       value<bool>()->default_value("false"));
 
     opts.add_options()("l,list", "Print every prime up to a given ceiling.",
                        value<uint64_t>()->default_value("0"));
 
-    opts.add_options()("t,test", "Print whether a given number is a prime.",
+    opts.add_options()("t,test",
+                       "Print whether a given number is a prime (repeatable, "
+                       "comma-separated, powers like 10^9 allowed).",
+                       value<std::vector<std::string>>());
+
+    opts.add_options()("next",
+                       "Print the primes immediately above a given number.",
+                       value<std::string>()->default_value(""));
+
+    opts.add_options()("prev",
+                       "Print the primes immediately below a given number.",
+                       value<std::string>()->default_value(""));
+
+    opts.add_options()("k,primes",
+                       "Number of primes for --next, --prev and --bits.",
+                       value<uint64_t>()->default_value("1"));
+
+    opts.add_options()("safe-primes",
+                       "Print safe primes p = 2q + 1 and their Sophie Germain "
+                       "primes q, in a --range or of a number of --bits.",
+                       value<bool>()->default_value("false"));
+
+    opts.add_options()("range",
+                       "Range LO,HI of safe primes to print (powers like "
+                       "2^40 allowed).",
+                       value<std::vector<std::string>>());
+
+    opts.add_options()("bits", "Print the first -k safe primes of B bits.",
+                       value<uint64_t>()->default_value("0"));
+
+    opts.add_options()("goldbach",
+                       "Print the number of Goldbach partitions and the "
+                       "smallest witness of every even number in a range "
+                       "given as LO,HI.",
+                       value<std::vector<std::string>>());
+
+    opts.add_options()("witnesses",
+                       "Only print the smallest witnesses for --goldbach.",
+                       value<bool>()->default_value("false"));
+
+    opts.add_options()("c,count",
+                       "Print the number of primes up to a given ceiling.",
+                       value<uint64_t>()->default_value("0"));
+
+    opts.add_options()("table",
+                       "Write a binary table of spf, phi, mu or omega for "
+                       "every number up to --ceiling.",
+                       value<std::string>()->default_value(""));
+
+    opts.add_options()("ceiling",
+                       "Largest number for the --table and --residues "
+                       "options.",
+                       value<uint64_t>()->default_value("0"));
+
+    opts.add_options()("residues",
+                       "Count the primes up to --ceiling in every residue "
+                       "class modulo Q.",
+                       value<uint64_t>()->default_value("0"));
+
+    opts.add_options()("interval",
+                       "Write the running counts of --residues as a CSV row "
+                       "about every STEP numbers.",
+                       value<std::string>()->default_value("0"));
+
+    opts.add_options()("build-index",
+                       "Write a pi index with a checkpoint every 2^24 numbers "
+                       "up to a given ceiling.",
                        value<uint64_t>()->default_value("0"));
 
+    opts.add_options()("pi-index",
+                       "Start --count and --index from the checkpoints of a "
+                       "pi index file.",
+                       value<std::string>()->default_value(""));
+
+    opts.add_options()("o,output", "Write the output to a file.",
+                       value<std::string>()->default_value(""));
+
+    opts.add_options()("checkpoint",
+                       "Periodically save the progress of --list or --count "
+                       "to a state file.",
+                       value<std::string>()->default_value(""));
+
+    opts.add_options()("resume",
+                       "Resume the --list or --count job saved in a state "
+                       "file.",
+                       value<std::string>()->default_value(""));
+
+    opts.add_options()("max-memory",
+                       "Largest number of bytes of memory to use (powers like "
+                       "2^30 allowed); the peak is reported to stderr.",
+                       value<std::string>()->default_value("0"));
+
+    opts.add_options()("shard",
+                       "Run part K of N of --list or --count and write a "
+                       "partial result to the output file.",
+                       value<std::string>()->default_value(""));
+
+    opts.add_options()("merge",
+                       "Combine the partial results of every shard of a job "
+                       "(repeatable, comma-separated).",
+                       value<std::vector<std::string>>());
+
+    opts.add_options()("trace",
+                       "Write a timeline of every thread's work to a file in "
+                       "the Chrome trace format (opens in Perfetto).",
+                       value<std::string>()->default_value(""));
+
+    opts.add_options()("progress", "Periodically report progress to stderr.",
+                       value<bool>()->default_value("false"));
+
     opts.add_options()("v,version", "Show version information.",
                        value<bool>()->default_value("false"));
 
@@ -58,26 +191,209 @@ void primal::Options::addOptions() {
                        value<bool>()->default_value("false"));
 }
 
+void primal::Options::readBatch(const std::string& path) {
+    using functions::QueryKind;
+    using utils::uint128_t;
+    using utils::string::parseExpression;
+
+    std::ifstream file;
+    if (path != "-") {
+        file.open(path);
+        if (!file) throw std::runtime_error("Could not open batch file.");
+    }
+    std::istream& input = path == "-" ? std::cin : file;
+
+    // Each line names the kind of query followed by its value.
+    std::string kind, value;
+    while (input >> kind >> value) {
+        if (kind == "index") {
+            queries.push_back({QueryKind::INDEX,
+                               parseExpression<uint128_t>(value)});
+        } else if (kind == "test") {
+            queries.push_back({QueryKind::TEST,
+                               parseExpression<uint128_t>(value)});
+        } else {
+            throw std::runtime_error("Invalid batch query.");
+        }
+    }
+    if (!input.eof()) throw std::runtime_error("Invalid batch query.");
+}
+
 void primal::Options::parseOptions(int argc, char** argv) {
     // Assign the argument values to their respective attributes.
     auto parsedOpts = opts.parse(argc, argv);
-    indexArg = parsedOpts["index"].as<uint64_t>();
     listArg = parsedOpts["list"].as<uint64_t>();
-    testArg = parsedOpts["test"].as<uint64_t>();
+    countArg = parsedOpts["count"].as<uint64_t>();
+    auto nextText = parsedOpts["next"].as<std::string>();
+    auto prevText = parsedOpts["prev"].as<std::string>();
+    primesArg = parsedOpts["primes"].as<uint64_t>();
+    bool goldbachFlag = parsedOpts.count("goldbach") > 0;
+    bool safePrimesFlag = parsedOpts["safe-primes"].as<bool>();
+    auto bitsArg = parsedOpts["bits"].as<uint64_t>();
+    witnessesArg = parsedOpts["witnesses"].as<bool>();
+    auto tableName = parsedOpts["table"].as<std::string>();
+    ceilingArg = parsedOpts["ceiling"].as<uint64_t>();
+    residuesArg = parsedOpts["residues"].as<uint64_t>();
+    intervalArg = utils::string::parseExpression<uint64_t>(
+        parsedOpts["interval"].as<std::string>());
+    buildIndexArg = parsedOpts["build-index"].as<uint64_t>();
+    job.piIndex = parsedOpts["pi-index"].as<std::string>();
+    job.maxMemory = utils::string::parseExpression<uint64_t>(
+        parsedOpts["max-memory"].as<std::string>());
+    auto resumeArg = parsedOpts["resume"].as<std::string>();
+    job.output = parsedOpts["output"].as<std::string>();
+    job.state = parsedOpts["checkpoint"].as<std::string>();
+    job.progress = parsedOpts["progress"].as<bool>();
+    job.trace = parsedOpts["trace"].as<std::string>();
+    job.explain = parsedOpts["explain"].as<bool>();
+    auto batchArg = parsedOpts["batch"].as<std::string>();
+    auto shardArg = parsedOpts["shard"].as<std::string>();
+    if (parsedOpts.count("merge")) {
+        mergeArg = parsedOpts["merge"].as<std::vector<std::string>>();
+    }
     bool versionFlag = parsedOpts["version"].as<bool>();
     bool helpFlag = parsedOpts["help"].as<bool>();
 
-    // Total number of options provided.
-    int optCount = (indexArg ? 1 : 0) + (listArg ? 1 : 0) + (testArg ? 1 : 0) +
+    // Collect the index and test queries in the order they were given, which
+    // only the sequence of parsed arguments keeps across the two options.
+    using functions::QueryKind;
+    using utils::uint128_t;
+    using utils::string::parseExpression;
+    for (const auto& argument : parsedOpts.arguments()) {
+        QueryKind kind;
+        if (argument.key() == "index") {
+            kind = QueryKind::INDEX;
+        } else if (argument.key() == "test") {
+            kind = QueryKind::TEST;
+        } else {
+            continue;
+        }
+
+        // Split comma-separated lists like cxxopts does for vector options.
+        std::istringstream list(argument.value());
+        for (std::string value; std::getline(list, value, ',');) {
+            queries.push_back({kind, parseExpression<uint128_t>(value)});
+        }
+    }
+    if (!batchArg.empty()) readBatch(batchArg);
+
+    // Total number of options provided (queries count as one).
+    int optCount = (queries.empty() ? 0 : 1) + (listArg ? 1 : 0) +
+                   (countArg ? 1 : 0) + (tableName.empty() ? 0 : 1) +
+                   (buildIndexArg ? 1 : 0) + (nextText.empty() ? 0 : 1) +
+                   (prevText.empty() ? 0 : 1) + (goldbachFlag ? 1 : 0) +
+                   (mergeArg.empty() ? 0 : 1) + (safePrimesFlag ? 1 : 0) +
+                   (residuesArg ? 1 : 0) + (resumeArg.empty() ? 0 : 1) +
                    (versionFlag ? 1 : 0) + (helpFlag ? 1 : 0);
 
     // Only allow 1 option to be entered.
     if (optCount > 1) throw std::runtime_error("Invalid options.");
 
     // Set the appropriate function for the option provided.
-    if (indexArg) function = Function::INDEX;
+    if (!queries.empty()) function = Function::QUERY;
     if (listArg) function = Function::LIST;
-    if (testArg) function = Function::TEST;
+    if (countArg) function = Function::COUNT;
+    if (!tableName.empty()) function = Function::TABLE;
+    if (residuesArg) function = Function::RESIDUES;
+    if (buildIndexArg) function = Function::BUILD_INDEX;
+    if (!nextText.empty()) {
+        function = Function::NEXT;
+        adjacentArg = parseExpression<uint128_t>(nextText);
+    }
+    if (!prevText.empty()) {
+        function = Function::PREV;
+        adjacentArg = parseExpression<uint128_t>(prevText);
+    }
+    if (goldbachFlag) {
+        function = Function::GOLDBACH;
+        auto range = parsedOpts["goldbach"].as<std::vector<std::string>>();
+        if (range.size() != 2) {
+            throw std::runtime_error("Invalid Goldbach range.");
+        }
+        goldbachLowArg = parseExpression<uint64_t>(range[0]);
+        goldbachHighArg = parseExpression<uint64_t>(range[1]);
+    }
+    if (!mergeArg.empty()) function = Function::MERGE;
+    if (safePrimesFlag) {
+        function = Function::SAFE_PRIMES;
+        if ((parsedOpts.count("range") > 0) == (bitsArg > 0)) {
+            throw std::runtime_error("Give either --range or --bits.");
+        }
+        if (bitsArg) {
+            // Every number with exactly the given number of bits.
+            if (bitsArg < 3 || bitsArg > 64) {
+                throw std::runtime_error("Invalid number of bits.");
+            }
+            rangeLowArg = uint64_t{1} << (bitsArg - 1);
+            rangeHighArg = UINT64_MAX >> (64 - bitsArg);
+        } else {
+            auto range = parsedOpts["range"].as<std::vector<std::string>>();
+            if (range.size() != 2) {
+                throw std::runtime_error("Invalid safe prime range.");
+            }
+            rangeLowArg = parseExpression<uint64_t>(range[0]);
+            rangeHighArg = parseExpression<uint64_t>(range[1]);
+            primesArg = 0;
+        }
+    }
     if (versionFlag) function = Function::VERSION;
     if (helpFlag) function = Function::HELP;
+
+    // Look up the arithmetic function to tabulate.
+    if (function == Function::TABLE) {
+        using utils::math::ArithmeticFunction;
+        if (tableName == "spf") tableArg = ArithmeticFunction::SPF;
+        else if (tableName == "phi") tableArg = ArithmeticFunction::PHI;
+        else if (tableName == "mu") tableArg = ArithmeticFunction::MU;
+        else if (tableName == "omega") tableArg = ArithmeticFunction::OMEGA;
+        else throw std::runtime_error("Invalid table.");
+
+        if (!parsedOpts.count("ceiling")) {
+            throw std::runtime_error("--table needs --ceiling.");
+        }
+    }
+
+    // Tables and pi indices are binary, so they must not end up on a
+    // terminal.
+    if ((function == Function::TABLE || function == Function::BUILD_INDEX) &&
+        job.output.empty() && ::isatty(STDOUT_FILENO)) {
+        std::string name =
+            function == Function::TABLE ? "--table" : "--build-index";
+        throw std::runtime_error(
+            name + " needs an output file or a redirected stdout.");
+    }
+
+    // The residue classes are counted up to --ceiling, which has no default.
+    if (function == Function::RESIDUES && !parsedOpts.count("ceiling")) {
+        throw std::runtime_error("--residues needs --ceiling.");
+    }
+
+    // A shard writes its partial result to a file that --merge reads.
+    if (!shardArg.empty()) {
+        job.shard = utils::Shard::parse(shardArg);
+        if (function != Function::LIST && function != Function::COUNT) {
+            throw std::runtime_error("Only --list and --count can be sharded.");
+        }
+        if (job.output.empty() || !job.state.empty() || !resumeArg.empty()) {
+            throw std::runtime_error(
+                "A shard needs an output file and cannot be checkpointed.");
+        }
+    }
+
+    // Continue the job saved in the state file, checkpointing to it again.
+    if (!resumeArg.empty()) {
+        job.resume = utils::Checkpoint::load(resumeArg);
+        job.output = job.resume.output;
+        if (job.state.empty()) job.state = resumeArg;
+
+        if (job.resume.function == "list") {
+            function = Function::LIST;
+            listArg = job.resume.ceiling;
+        } else if (job.resume.function == "count") {
+            function = Function::COUNT;
+            countArg = job.resume.ceiling;
+        } else {
+            throw std::runtime_error("Invalid state file.");
+        }
+    }
 }
@@ -29,11 +29,23 @@
 #include <stdexcept>
 
 #include "primal/ascii-art.hpp"
+#include "primal/functions/adjacent.hpp"
+#include "primal/functions/build-index.hpp"
+#include "primal/functions/count.hpp"
+#include "primal/functions/goldbach.hpp"
 #include "primal/functions/index.hpp"
 #include "primal/functions/list.hpp"
+#include "primal/functions/merge.hpp"
+#include "primal/functions/query.hpp"
+#include "primal/functions/residues.hpp"
+#include "primal/functions/safe-primes.hpp"
+#include "primal/functions/table.hpp"
 #include "primal/functions/test.hpp"
 #include "primal/options.hpp"
+#include "primal/utils/math/kernels.hpp"
+#include "primal/utils/memory-budget.hpp"
 #include "primal/utils/prompt.hpp"
+#include "primal/utils/trace.hpp"
 #include "primal/version.hpp"
 
 void primal::session() {
@@ -60,18 +72,62 @@ void primal::session() {
 }
 
 void primal::session(const Options& options) {
+    if (!options.job.trace.empty()) utils::trace::start();
+
     switch (options.function) {
-    case Function::INDEX:
-        functions::index(options.indexArg);
+    case Function::QUERY:
+        functions::query<uint64_t>(options.queries, options.job);
         break;
     case Function::LIST:
-        functions::list(options.listArg);
+        functions::list(options.listArg, options.job);
         break;
-    case Function::TEST:
-        functions::test(options.testArg);
+    case Function::COUNT:
+        functions::count(options.countArg, options.job);
+        break;
+    case Function::TABLE:
+        functions::table(options.ceilingArg, options.tableArg, options.job);
+        break;
+    case Function::BUILD_INDEX:
+        functions::buildIndex(options.buildIndexArg, options.job);
+        break;
+    case Function::NEXT:
+        // Searches that may cross 2^64 need wide arithmetic.
+        if (options.adjacentArg < uint64_t{1} << 63) {
+            functions::next(static_cast<uint64_t>(options.adjacentArg),
+                            options.primesArg, options.job);
+        } else {
+            functions::next(options.adjacentArg, options.primesArg,
+                            options.job);
+        }
+        break;
+    case Function::PREV:
+        if (options.adjacentArg <= UINT64_MAX) {
+            functions::prev(static_cast<uint64_t>(options.adjacentArg),
+                            options.primesArg, options.job);
+        } else {
+            functions::prev(options.adjacentArg, options.primesArg,
+                            options.job);
+        }
+        break;
+    case Function::GOLDBACH:
+        functions::goldbach(options.goldbachLowArg, options.goldbachHighArg,
+                            options.witnessesArg, options.job);
+        break;
+    case Function::MERGE:
+        functions::merge(options.mergeArg, options.job);
+        break;
+    case Function::SAFE_PRIMES:
+        functions::safePrimes(options.rangeLowArg, options.rangeHighArg,
+                              options.primesArg, options.job);
+        break;
+    case Function::RESIDUES:
+        functions::residues(options.ceilingArg, options.residuesArg,
+                            options.intervalArg, options.job);
         break;
     case Function::VERSION:
-        std::cout << "Version: " << version << "\n";
+        std::cout << "Version: " << version << "\n"
+                  << "Kernels: " << utils::math::kernels::instructionSet()
+                  << "\n";
         break;
     case Function::HELP:
         std::cout << options.getHelpText() << "\n";
@@ -79,4 +135,12 @@ void primal::session(const Options& options) {
     default:
         throw std::runtime_error("Invalid option.");
     }
+
+    if (!options.job.trace.empty()) utils::trace::write(options.job.trace);
+
+    // Report the peak so that the budget can be tuned.
+    if (options.job.maxMemory) {
+        std::cerr << "Peak memory: " << utils::MemoryBudget::peak() << " of "
+                  << options.job.maxMemory << " bytes.\n";
+    }
 }